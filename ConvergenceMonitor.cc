@@ -0,0 +1,259 @@
+//
+// This file is part of an OMNeT++/OMNEST simulation example.
+//
+// Copyright (C) 1992-2015 Andras Varga
+//
+// This file is distributed WITHOUT ANY WARRANTY. See the file
+// `license' for details on this and other legal matters.
+//
+
+#include "ConvergenceMonitor.h"
+
+namespace csma {
+
+Define_Module(ConvergenceMonitor);
+
+// MSER-5: the truncation point is searched over means of 5 consecutive batches
+static const int MSER_GROUP = 5;
+// the last few group means alone give a meaningless, tiny MSER
+static const int MSER_MIN_TAIL = 2;
+
+ConvergenceMonitor::~ConvergenceMonitor()
+{
+    cancelAndDelete(batchEvent);
+}
+
+void ConvergenceMonitor::initialize()
+{
+    batchLength = par("batchLength");
+    targetPrecision = par("targetPrecision");
+    minBatches = par("minBatches");
+    minWarmupBatches = par("minWarmupBatches");
+    if (batchLength <= 0)
+        throw cRuntimeError("batchLength must be positive");
+    if (minBatches < 2)
+        throw cRuntimeError("minBatches must be at least 2");
+
+    busyTime = 0;
+    receiveStart = 0;
+    delaySum = 0;
+    delayCount = 0;
+    receivedFrames = 0;
+    collidedFrames = 0;
+    warmupDetected = false;
+    truncatedBatches = 0;
+    warmupTime = 0;
+    converged = false;
+    WATCH(warmupDetected);
+    WATCH(warmupTime);
+
+    // the server emits receive/collision; accessDelay comes from every host
+    // and is caught on the network module the hosts propagate it to
+    cModule *server = getModuleByPath("server");
+    receiveSignalId = registerSignal("receive");
+    collisionSignalId = registerSignal("collision");
+    accessDelaySignalId = registerSignal("accessDelay");
+    server->subscribe(receiveSignalId, this);
+    server->subscribe(collisionSignalId, this);
+    getParentModule()->subscribe(accessDelaySignalId, this);
+
+    batchEvent = new cMessage("batch");
+    scheduleAt(simTime() + batchLength, batchEvent);
+}
+
+void ConvergenceMonitor::handleMessage(cMessage *msg)
+{
+    ASSERT(msg == batchEvent);
+    endBatch();
+    if (!converged)
+        scheduleAt(simTime() + batchLength, batchEvent);
+}
+
+void ConvergenceMonitor::receiveSignal(cComponent *source, simsignal_t signalID, cObject *obj, cObject *details)
+{
+    // both are emitted at the end of the reception, stamped with its start
+    cITimestampedValue *value = check_and_cast<cITimestampedValue *>(obj);
+    if (signalID == receiveSignalId) {
+        // 1 at the start, 0 at the end of a reception, emitted together at
+        // the end of the busy period; accounted in the batch it ends in
+        if (value->intValue(signalID) != 0) {
+            receiveStart = value->getTimestamp(signalID);
+            receivedFrames++;
+        }
+        else
+            busyTime += value->getTimestamp(signalID) - receiveStart;
+    }
+    else if (signalID == collisionSignalId) {
+        collidedFrames += value->intValue(signalID);
+    }
+}
+
+void ConvergenceMonitor::receiveSignal(cComponent *source, simsignal_t signalID, const SimTime& t, cObject *details)
+{
+    if (signalID == accessDelaySignalId) {
+        delaySum += t.dbl();
+        delayCount++;
+    }
+}
+
+void ConvergenceMonitor::receiveSignal(cComponent *source, simsignal_t signalID, intval_t i, cObject *details)
+{
+    // the initial plain 0 of "receive"; cListener throws on unhandled types
+}
+
+void ConvergenceMonitor::endBatch()
+{
+    utilization.push_back(busyTime / batchLength);
+    accessDelay.push_back(delayCount > 0 ? delaySum / delayCount : NAN);
+    delaySamples.push_back(delayCount);
+    received.push_back(receivedFrames);
+    collided.push_back(collidedFrames);
+    EV << "batch " << utilization.size() << ": utilization " << utilization.back()
+       << ", access delay " << accessDelay.back() << ", collided frames " << collidedFrames << endl;
+
+    busyTime = 0;
+    delaySum = 0;
+    delayCount = 0;
+    receivedFrames = 0;
+    collidedFrames = 0;
+
+    if (!warmupDetected) {
+        if ((int)utilization.size() < minWarmupBatches)
+            return;
+        int d = computeMserTruncation();
+        if (d < 0)
+            return;
+
+        // statistics restart at the truncation point: earlier batches are dropped
+        warmupDetected = true;
+        truncatedBatches = d * MSER_GROUP;
+        warmupTime = truncatedBatches * batchLength;
+        utilization.erase(utilization.begin(), utilization.begin() + truncatedBatches);
+        accessDelay.erase(accessDelay.begin(), accessDelay.begin() + truncatedBatches);
+        delaySamples.erase(delaySamples.begin(), delaySamples.begin() + truncatedBatches);
+        received.erase(received.begin(), received.begin() + truncatedBatches);
+        collided.erase(collided.begin(), collided.begin() + truncatedBatches);
+        EV << "end of warm-up detected at t=" << warmupTime << endl;
+        if (hasGUI())
+            bubble("warm-up over");
+    }
+
+    if ((int)utilization.size() < minBatches)
+        return;
+
+    Estimate u = estimate(utilization);
+    Estimate a = estimate(accessDelay);
+    if (u.count >= minBatches && a.count >= minBatches &&
+            u.halfWidth <= targetPrecision * std::fabs(u.mean) &&
+            a.halfWidth <= targetPrecision * std::fabs(a.mean)) {
+        EV << "target precision reached after " << utilization.size() << " batches" << endl;
+        converged = true;
+        endSimulation();
+    }
+}
+
+int ConvergenceMonitor::computeMserTruncation() const
+{
+    // means of consecutive groups of MSER_GROUP batches
+    int m = utilization.size() / MSER_GROUP;
+    std::vector<double> z(m);
+    for (int j = 0; j < m; j++) {
+        double sum = 0;
+        for (int k = 0; k < MSER_GROUP; k++)
+            sum += utilization[j * MSER_GROUP + k];
+        z[j] = sum / MSER_GROUP;
+    }
+
+    // MSER(d) = sum_{j>=d} (z_j - mean_d)^2 / (m-d)^2, from suffix sums;
+    // minimized over every d that leaves at least MSER_MIN_TAIL group means
+    double s1 = 0, s2 = 0;
+    double best = INFINITY;
+    int bestD = -1;
+    for (int d = m - 1; d >= 0; d--) {
+        s1 += z[d];
+        s2 += z[d] * z[d];
+        int n = m - d;
+        double mser = (s2 - s1 * s1 / n) / ((double)n * n);
+        if (n >= MSER_MIN_TAIL && mser <= best) {
+            best = mser;
+            bestD = d;
+        }
+    }
+
+    // a minimum in the second half means the series is still trending
+    return bestD >= 0 && bestD <= m / 2 ? bestD : -1;
+}
+
+ConvergenceMonitor::Estimate ConvergenceMonitor::estimate(const std::vector<double>& series) const
+{
+    double sum = 0, sumSq = 0;
+    int n = 0;
+    for (double v : series) {
+        if (std::isnan(v))
+            continue;
+        sum += v;
+        sumSq += v * v;
+        n++;
+    }
+
+    Estimate e;
+    e.count = n;
+    e.mean = n > 0 ? sum / n : NAN;
+    if (n < 2) {
+        e.halfWidth = INFINITY;
+        return e;
+    }
+    double var = std::max(0.0, (sumSq - sum * sum / n) / (n - 1));
+    e.halfWidth = studentT975(n - 1) * std::sqrt(var / n);
+    return e;
+}
+
+double ConvergenceMonitor::studentT975(int dof)
+{
+    // 97.5% quantile of Student's t, i.e. a two-sided 95% interval
+    static const double table[] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+    if (dof <= 30)
+        return table[dof - 1];
+    return 1.960 + 2.373 / dof;
+}
+
+void ConvergenceMonitor::finish()
+{
+    Estimate u = estimate(utilization);
+    Estimate a = estimate(accessDelay);
+
+    // the results of the run from the truncation point on; the server's and
+    // the hosts' own recorders cover the whole run including the transient
+    double delayTotal = 0;
+    long delayTotalCount = 0, receivedSum = 0, collidedSum = 0;
+    for (size_t i = 0; i < utilization.size(); i++) {
+        if (delaySamples[i] > 0) {
+            delayTotal += accessDelay[i] * delaySamples[i];
+            delayTotalCount += delaySamples[i];
+        }
+        receivedSum += received[i];
+        collidedSum += collided[i];
+    }
+
+    if (warmupDetected)
+        EV << "warm-up ended at t=" << warmupTime << ", results of this module exclude it\n";
+    else
+        EV << "no end of warm-up detected, results of this module include the transient\n";
+    recordScalar("warmupDetected", warmupDetected);
+    recordScalar("warmupTime", warmupTime, "s");
+    recordScalar("truncatedBatches", truncatedBatches);
+    recordScalar("batches", utilization.size());
+    recordScalar("converged", converged);
+    recordScalar("channelUtilization", u.mean);
+    recordScalar("channelUtilizationRelHalfWidth", u.halfWidth / std::fabs(u.mean));
+    recordScalar("accessDelay:mean", delayTotalCount > 0 ? delayTotal / delayTotalCount : NAN, "s");
+    recordScalar("accessDelayRelHalfWidth", a.halfWidth / std::fabs(a.mean));
+    recordScalar("receivedFrames", receivedSum);
+    recordScalar("collidedFrames", collidedSum);
+}
+
+}; //namespace
@@ -0,0 +1,83 @@
+//
+// This file is part of an OMNeT++/OMNEST simulation example.
+//
+// Copyright (C) 1992-2015 Andras Varga
+//
+// This file is distributed WITHOUT ANY WARRANTY. See the file
+// `license' for details on this and other legal matters.
+//
+
+#ifndef __CSMA_CONVERGENCEMONITOR_H_
+#define __CSMA_CONVERGENCEMONITOR_H_
+
+#include <vector>
+
+#include <omnetpp.h>
+
+using namespace omnetpp;
+
+namespace csma {
+
+/**
+ * Warm-up detection and precision-based run termination; see NED file
+ * for more info.
+ */
+class ConvergenceMonitor : public cSimpleModule, public cListener
+{
+  private:
+    // parameters
+    simtime_t batchLength;
+    double targetPrecision;
+    int minBatches;
+    int minWarmupBatches;
+
+    // signals listened to
+    simsignal_t receiveSignalId;
+    simsignal_t collisionSignalId;
+    simsignal_t accessDelaySignalId;
+
+    // accumulators of the current batch
+    simtime_t busyTime;
+    simtime_t receiveStart; // of the reception being reported
+    double delaySum;
+    long delayCount;
+    long receivedFrames;
+    long collidedFrames;
+
+    // per batch since the truncation point (since the start of the run
+    // before it is found); accessDelay is NaN for batches without samples
+    std::vector<double> utilization;
+    std::vector<double> accessDelay;
+    std::vector<long> delaySamples;
+    std::vector<long> received;
+    std::vector<long> collided;
+
+    bool warmupDetected;
+    int truncatedBatches;
+    simtime_t warmupTime;
+    bool converged;
+
+    cMessage *batchEvent = nullptr;
+
+    struct Estimate { double mean, halfWidth; int count; };
+
+  public:
+    virtual ~ConvergenceMonitor();
+
+  protected:
+    virtual void initialize() override;
+    virtual void handleMessage(cMessage *msg) override;
+    virtual void finish() override;
+    virtual void receiveSignal(cComponent *source, simsignal_t signalID, cObject *obj, cObject *details) override;
+    virtual void receiveSignal(cComponent *source, simsignal_t signalID, const SimTime& t, cObject *details) override;
+    virtual void receiveSignal(cComponent *source, simsignal_t signalID, intval_t i, cObject *details) override;
+
+    void endBatch();
+    int computeMserTruncation() const;
+    Estimate estimate(const std::vector<double>& series) const;
+    static double studentT975(int dof);
+};
+
+}; //namespace
+
+#endif
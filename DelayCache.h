@@ -0,0 +1,58 @@
+//
+// This file is part of an OMNeT++/OMNEST simulation example.
+//
+// Copyright (C) 1992-2015 Andras Varga
+//
+// This file is distributed WITHOUT ANY WARRANTY. See the file
+// `license' for details on this and other legal matters.
+//
+
+#ifndef __CSMA_DELAYCACHE_H_
+#define __CSMA_DELAYCACHE_H_
+
+#include <algorithm>
+#include <vector>
+
+#include <omnetpp.h>
+
+using namespace omnetpp;
+
+namespace csma {
+
+/**
+ * Propagation delays from one node to a set of peers. An entry is computed
+ * on first use, and again only after the peer's position version changed.
+ * A cache of size 0 stores nothing and computes every delay on use.
+ * Used by Host and Server, and timed by benchmarks/mac_bench.cc.
+ */
+class DelayCache
+{
+  public:
+    static constexpr double propagationSpeed = 299792458.0; // speed of light in m/s
+
+  private:
+    std::vector<simtime_t> delays;
+    std::vector<long> versions; // peer's position version at computation, -1 if stale
+
+  public:
+    static simtime_t propagationDelay(double dx, double dy) { return std::sqrt(dx * dx + dy * dy) / propagationSpeed; }
+
+    void setSize(int n) { delays.assign(n, SIMTIME_ZERO); versions.assign(n, -1); }
+    // drops every entry, e.g. after the owner itself moved
+    void invalidate() { std::fill(versions.begin(), versions.end(), -1); }
+
+    // delay from (x, y) to peer i, currently at (peerX, peerY)
+    simtime_t get(int i, double x, double y, double peerX, double peerY, long peerVersion) {
+        if (versions.empty())
+            return propagationDelay(x - peerX, y - peerY);
+        if (versions[i] != peerVersion) {
+            delays[i] = propagationDelay(x - peerX, y - peerY);
+            versions[i] = peerVersion;
+        }
+        return delays[i];
+    }
+};
+
+}; //namespace
+
+#endif
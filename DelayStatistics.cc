@@ -0,0 +1,151 @@
+//
+// This file is part of an OMNeT++/OMNEST simulation example.
+//
+// Copyright (C) 1992-2015 Andras Varga
+//
+// This file is distributed WITHOUT ANY WARRANTY. See the file
+// `license' for details on this and other legal matters.
+//
+
+#include <algorithm>
+
+#include "DelayStatistics.h"
+
+namespace csma {
+
+Define_Module(DelayStatistics);
+
+QuantileEstimator::QuantileEstimator(double p) : p(p)
+{
+    step[0] = 0;
+    step[1] = p / 2;
+    step[2] = p;
+    step[3] = (1 + p) / 2;
+    step[4] = 1;
+}
+
+void QuantileEstimator::add(double x)
+{
+    // the first five samples become the initial markers
+    if (count < 5) {
+        q[count++] = x;
+        if (count == 5) {
+            std::sort(q, q + 5);
+            for (int i = 0; i < 5; i++)
+                n[i] = i + 1;
+            want[0] = 1;
+            want[1] = 1 + 2 * p;
+            want[2] = 1 + 4 * p;
+            want[3] = 3 + 2 * p;
+            want[4] = 5;
+        }
+        return;
+    }
+    count++;
+
+    // cell k with q[k] <= x < q[k+1]; the extreme markers follow min and max
+    int k;
+    if (x < q[0]) {
+        q[0] = x;
+        k = 0;
+    }
+    else if (x >= q[4]) {
+        q[4] = std::max(q[4], x);
+        k = 3;
+    }
+    else {
+        k = 0;
+        while (x >= q[k + 1])
+            k++;
+    }
+    for (int i = k + 1; i < 5; i++)
+        n[i]++;
+    for (int i = 0; i < 5; i++)
+        want[i] += step[i];
+
+    // move the middle markers towards their desired positions
+    for (int i = 1; i <= 3; i++) {
+        double d = want[i] - n[i];
+        if ((d >= 1 && n[i + 1] - n[i] > 1) || (d <= -1 && n[i - 1] - n[i] < -1)) {
+            int s = d >= 0 ? 1 : -1;
+            double qp = parabolic(i, s);
+            q[i] = q[i - 1] < qp && qp < q[i + 1] ? qp : linear(i, s);
+            n[i] += s;
+        }
+    }
+}
+
+double QuantileEstimator::parabolic(int i, int d) const
+{
+    return q[i] + d / (n[i + 1] - n[i - 1]) *
+            ((n[i] - n[i - 1] + d) * (q[i + 1] - q[i]) / (n[i + 1] - n[i]) +
+             (n[i + 1] - n[i] - d) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]));
+}
+
+double QuantileEstimator::linear(int i, int d) const
+{
+    return q[i] + d * (q[i + d] - q[i]) / (n[i + d] - n[i]);
+}
+
+double QuantileEstimator::get() const
+{
+    if (count >= 5)
+        return q[2];
+    if (count == 0)
+        return NAN;
+    // nearest rank among the few samples seen
+    double sorted[5];
+    std::copy(q, q + count, sorted);
+    std::sort(sorted, sorted + count);
+    int rank = std::max((int)std::ceil(p * count), 1);
+    return sorted[rank - 1];
+}
+
+void DelayStatistics::initialize()
+{
+    for (double pct : cStringTokenizer(par("percentiles")).asDoubleVector()) {
+        if (pct <= 0 || pct >= 100)
+            throw cRuntimeError("percentiles must be between 0 and 100, got %g", pct);
+        percentiles.push_back(pct);
+    }
+
+    // the hosts' per-class signals propagate up to the network module
+    static const char *names[] = { "BK", "BE", "VI", "VO" };
+    for (const char *name : names) {
+        Class c;
+        c.name = name;
+        c.signalId = registerSignal((std::string("accessDelay") + name).c_str());
+        for (double pct : percentiles)
+            c.estimators.push_back(QuantileEstimator(pct / 100));
+        classes.push_back(c);
+        getParentModule()->subscribe(c.signalId, this);
+    }
+}
+
+void DelayStatistics::receiveSignal(cComponent *source, simsignal_t signalID, const SimTime& t, cObject *details)
+{
+    for (auto& c : classes) {
+        if (c.signalId == signalID) {
+            for (auto& e : c.estimators)
+                e.add(t.dbl());
+            return;
+        }
+    }
+}
+
+void DelayStatistics::finish()
+{
+    for (auto& c : classes) {
+        if (c.estimators.empty() || c.estimators[0].getCount() == 0)
+            continue;
+        std::string prefix = std::string("accessDelay") + c.name;
+        recordScalar((prefix + ":count").c_str(), c.estimators[0].getCount());
+        for (size_t i = 0; i < percentiles.size(); i++) {
+            char name[64];
+            snprintf(name, sizeof(name), "%s:p%g", prefix.c_str(), percentiles[i]);
+            recordScalar(name, c.estimators[i].get(), "s");
+        }
+    }
+}
+
+}; //namespace
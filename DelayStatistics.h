@@ -0,0 +1,69 @@
+//
+// This file is part of an OMNeT++/OMNEST simulation example.
+//
+// Copyright (C) 1992-2015 Andras Varga
+//
+// This file is distributed WITHOUT ANY WARRANTY. See the file
+// `license' for details on this and other legal matters.
+//
+
+#ifndef __CSMA_DELAYSTATISTICS_H_
+#define __CSMA_DELAYSTATISTICS_H_
+
+#include <vector>
+
+#include <omnetpp.h>
+
+using namespace omnetpp;
+
+namespace csma {
+
+/**
+ * Streaming estimate of one quantile with the P-square algorithm (Jain and
+ * Chlamtac, 1985): five markers, constant memory, no samples kept.
+ */
+class QuantileEstimator
+{
+  private:
+    double p;
+    long count = 0;
+    double q[5];    // marker heights
+    double n[5];    // marker positions, 1-based
+    double want[5]; // desired marker positions
+    double step[5]; // increments of the desired positions
+
+    double parabolic(int i, int d) const;
+    double linear(int i, int d) const;
+
+  public:
+    explicit QuantileEstimator(double p);
+    void add(double x);
+    long getCount() const { return count; }
+    // exact below five samples, NaN without any
+    double get() const;
+};
+
+/**
+ * Network-wide per-class access delay percentiles; see NED file for more info.
+ */
+class DelayStatistics : public cSimpleModule, public cListener
+{
+  private:
+    struct Class
+    {
+        const char *name;
+        simsignal_t signalId;
+        std::vector<QuantileEstimator> estimators; // one per entry of percentiles
+    };
+    std::vector<double> percentiles;
+    std::vector<Class> classes;
+
+  protected:
+    virtual void initialize() override;
+    virtual void finish() override;
+    virtual void receiveSignal(cComponent *source, simsignal_t signalID, const SimTime& t, cObject *details) override;
+};
+
+}; //namespace
+
+#endif
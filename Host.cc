@@ -11,6 +11,7 @@
 
 #include "Host.h"
 #include "Server.h"
+#include "Topology.h"
 
 namespace csma {
 
@@ -20,6 +21,10 @@ Host::~Host()
 {
     delete lastPacket;
     cancelAndDelete(endTxEvent);
+    cancelAndDelete(moveEvent);
+    delete mobility;
+    for (auto& ac : acs)
+        cancelAndDelete(ac.arrivalEvent);
 }
 
 void Host::initialize()
@@ -27,11 +32,10 @@ void Host::initialize()
     gate("in")->setDeliverImmediately(true);
 
     stateSignal = registerSignal("state");
+    accessDelaySignal = registerSignal("accessDelay");
     server = getModuleByPath("server");
 
     txRate = par("txRate");
-    iaTime = &par("iaTime");
-    pkLenBits = &par("pkLenBits");
 
     slotTime = par("slotTime");
     WATCH(slotTime);
@@ -43,51 +47,64 @@ void Host::initialize()
     WATCH((int&)state);
     WATCH(pkCounter);
 
-    x = par("x").doubleValue();
-    y = par("y").doubleValue();
-
-    double serverX = server->par("x").doubleValue();
-    double serverY = server->par("y").doubleValue();
+    double serverX, serverY;
+    const char *topologyFile = par("topologyFile");
+    if (*topologyFile) {
+        // placement file; the x/y parameters are not used
+        const Topology *topology = Topology::get(topologyFile);
+        if (getVectorSize() > topology->getNumHosts())
+            throw cRuntimeError("Topology file '%s' has %d hosts, network has %d",
+                    topologyFile, topology->getNumHosts(), getVectorSize());
+        x = topology->getHostX(getIndex());
+        y = topology->getHostY(getIndex());
+        serverX = topology->getServerX();
+        serverY = topology->getServerY();
+    }
+    else {
+        x = par("x").doubleValue();
+        y = par("y").doubleValue();
+        serverX = server->par("x").doubleValue();
+        serverY = server->par("y").doubleValue();
+    }
+    positionVersion = 0;
 
     idleAnimationSpeed = par("idleAnimationSpeed");
     transmissionEdgeAnimationSpeed = par("transmissionEdgeAnimationSpeed");
     midtransmissionAnimationSpeed = par("midTransmissionAnimationSpeed");
 
-    double dist = std::sqrt((x-serverX) * (x-serverX) + (y-serverY) * (y-serverY));
-    radioDelay = dist / propagationSpeed;
+    radioDelay = computeDelay(serverX, serverY);
 
     getDisplayString().setTagArg("p", 0, x);
     getDisplayString().setTagArg("p", 1, y);
 
 
     channelBusy = 0;
-    backoffTime = 0;
-    maxBackoffs = par("maxBackoffs");
-    backoffCount = 0;
     backoff = new cMessage("backoff");
     
     channelStateSignal = registerSignal("channelState");
     server->subscribe("channelState", this);
 
+    // the server fills its host table in its own initialize(); it is only
+    // read from handleMessage() on. Peers may not be initialized yet either,
+    // delays are computed on first use
     numOtherHosts = getVectorSize() - 1;
-    otherHostGate = new cGate *[numOtherHosts];
-    otherHosts = new cModule *[numOtherHosts];
-    otherHostDelay = new simtime_t [numOtherHosts];
-    char hostname[10] = "host[x]";
-    int index = 0;
-    for (int i = 0; i < numOtherHosts + 1; i++) {
-        if (i != getIndex()) {
-            snprintf(hostname, sizeof(hostname), "host[%d]", i);
-            otherHosts[index] = getModuleByPath(hostname);
-            otherHostGate[index] = otherHosts[index]->gate("in");
-
-            double dist = std::sqrt((x-otherHosts[index]->par("x").doubleValue()) * \
-                    (x-otherHosts[index]->par("x").doubleValue()) + \
-                    (y-otherHosts[index]->par("y").doubleValue()) * \
-                    (y-otherHosts[index]->par("y").doubleValue()));
-            otherHostDelay[index] = dist / propagationSpeed;
-            index++;
-        }
+    hostTable = check_and_cast<Server *>(server);
+    if (numOtherHosts <= par("maxDelayCachePeers").intValue())
+        otherHostDelays.setSize(numOtherHosts);
+    cModule *network = getParentModule();
+
+    medium = dynamic_cast<RadioMedium *>(network->getSubmodule("medium"));
+    txPower = par("txPower");
+
+    mobility = MobilityModel::create(par("mobilityType"), this,
+            par("constraintAreaMinX").doubleValue(), par("constraintAreaMinY").doubleValue(),
+            par("constraintAreaMaxX").doubleValue(), par("constraintAreaMaxY").doubleValue());
+    if (mobility != nullptr) {
+        mobilityUpdateInterval = par("mobilityUpdateInterval");
+        if (mobilityUpdateInterval <= 0)
+            throw cRuntimeError("mobilityUpdateInterval must be positive");
+        moveEvent = new cMessage("move");
+        scheduleAt(simTime() + mobilityUpdateInterval, moveEvent);
     }
 
     DIFSEvent = new cMessage("DIFSEvent");
@@ -100,7 +117,61 @@ void Host::initialize()
     cancleChannelBusy = new cMessage("cancleChannelBusy");
 
     contentFailFlag = false;
-    scheduleAt(getNextTransmissionTime(), DIFSEvent);
+    initAccessCategories();
+    if (!edca)
+        scheduleAt(getNextTransmissionTime(), DIFSEvent);
+}
+
+void Host::initAccessCategories()
+{
+    edca = par("edca");
+    currentAC = 0;
+    txopStart = 0;
+
+    if (!edca) {
+        // legacy MAC: DIFS, and a window of 2^(2+backoffCount)-1 slots that
+        // stops growing after maxBackoffs backoffs
+        AccessCategory ac;
+        ac.aifs = DIFS;
+        ac.cwMin = contentionWindow(0);
+        ac.cwMax = contentionWindow(par("maxBackoffs").intValue());
+        ac.txopLimit = 0;
+        ac.iaTime = &par("iaTime");
+        ac.pkLenBits = &par("pkLenBits");
+        acs.push_back(ac);
+        return;
+    }
+
+    static const char *names[] = { "BK", "BE", "VI", "VO" };
+    const int numACs = 4;
+    std::vector<int> aifsn = cStringTokenizer(par("aifsn")).asIntVector();
+    std::vector<int> cwMin = cStringTokenizer(par("cwMin")).asIntVector();
+    std::vector<int> cwMax = cStringTokenizer(par("cwMax")).asIntVector();
+    std::vector<double> txopLimit = cStringTokenizer(par("txopLimit")).asDoubleVector();
+    if ((int)aifsn.size() != numACs || (int)cwMin.size() != numACs || (int)cwMax.size() != numACs || (int)txopLimit.size() != numACs)
+        throw cRuntimeError("aifsn, cwMin, cwMax and txopLimit need one value per access category (BK BE VI VO)");
+
+    acs.resize(numACs);
+    for (int i = 0; i < numACs; i++) {
+        AccessCategory& ac = acs[i];
+        ac.name = names[i];
+        if (aifsn[i] < 1 || cwMin[i] < 0 || cwMax[i] < cwMin[i] || txopLimit[i] < 0)
+            throw cRuntimeError("Invalid EDCA parameters for access category %s", names[i]);
+        ac.aifs = SIFS + aifsn[i] * slotTime;
+        ac.cwMin = cwMin[i];
+        ac.cwMax = cwMax[i];
+        ac.txopLimit = txopLimit[i];
+        ac.iaTime = &par(("iaTime" + ac.name).c_str());
+        ac.pkLenBits = &par(("pkLenBits" + ac.name).c_str());
+        ac.delaySignal = registerSignal(("accessDelay" + ac.name).c_str());
+
+        // open-loop source per class; a zero interarrival time turns it off
+        simtime_t t = ac.iaTime->doubleValue();
+        if (t > 0) {
+            ac.arrivalEvent = new cMessage(("arrival-" + ac.name).c_str(), i);
+            scheduleAt(simTime() + t, ac.arrivalEvent);
+        }
+    }
 }
 
 void Host::handleMessage(cMessage *msg)
@@ -110,42 +181,49 @@ void Host::handleMessage(cMessage *msg)
     if (hasGUI() && msg == endTxEvent)
         getParentModule()->getCanvas()->setAnimationSpeed(transmissionEdgeAnimationSpeed, this);
 
+    if (medium != nullptr && !msg->isSelfMessage() && !isSensed(msg)) {
+        // below the carrier-sense threshold: the frame goes unnoticed
+        delete msg;
+        return;
+    }
+
     if (msg == DIFSEvent) {
-        if (channelBusy == 0) {
-            if (state == IDLE) {
-                // while channel is free and state is idle, wait for DIFS
-                scheduleAt(simTime() + DIFS, RTSEvent);
-            } else if (state == FREEZE) {
-                // maybe this part is not needed, its implementation is below
-                scheduleAt(simTime() + DIFS + backoffTime, RTSEvent);
-                DIFS_FLAG = simTime();
-            }
-        } else {
-            scheduleAt(simTime(), backoff);
-        }
+        // the closed-loop source (without EDCA): the next packet arrives now
+        acs[0].queue.push_back({simTime(), -1});
+        startAccess();
     } else if (msg == RTSEvent){
+        resolveInternalCollision();
         sendRTS();
     } else if (msg == endTxEvent) {
         if (state == BEFORE_SNED) {
-            // generate packet
+            // generate packet, unless its length was drawn on arrival
+            AccessCategory& ac = acs[currentAC];
             snprintf(pkname, sizeof(pkname), "pk-%d-#%d", getIndex(), pkCounter++);
             EV << "generating packet " << pkname << endl;
             pk = new cPacket(pkname);
-            pk->setBitLength(pkLenBits->intValue());
+            int64_t bitLength = ac.queue.front().bitLength;
+            pk->setBitLength(bitLength >= 0 ? bitLength : ac.pkLenBits->intValue());
 
             sendPacket(pk);
+        } else if (state == TRANSMIT && continueTxop()) {
+            // next frame of the same TXOP; peers stay deferred, no endListen yet
+            state = BEFORE_SNED;
+            scheduleAt(simTime() + SIFS, endTxEvent);
         } else if (state == TRANSMIT) {
             // endTxEvent indicates end of transmission
             state = IDLE;
             emit(stateSignal, state);
 
             // schedule next sending
-            scheduleAt(getNextTransmissionTime(), DIFSEvent);
+            if (!edca)
+                scheduleAt(getNextTransmissionTime(), DIFSEvent);
+            else
+                startAccess();
 
             // send to other hosts the finish signal
             for (int i = 0; i < numOtherHosts; i++) {
                 endListen = new cMessage("endListen");
-                sendDirect(endListen, otherHostDelay[i], 0, otherHostGate[i]);
+                sendDirect(endListen, getOtherHostDelay(i), 0, getOtherHostGate(i));
             }
         } else {
             throw cRuntimeError("invalid state");
@@ -154,10 +232,17 @@ void Host::handleMessage(cMessage *msg)
         // only compute backofftime
         EV << "host " << getIndex() << " backoff\n";
         state = FREEZE;
-        if (backoffCount < maxBackoffs) {
-            backoffCount += 1;
-        }
-        backoffTime = generateBackofftime();
+        increaseBackoff(acs[currentAC]);
+    } else if (msg == moveEvent) {
+        move();
+        scheduleAt(simTime() + mobilityUpdateInterval, moveEvent);
+    } else if (msg->isSelfMessage() && msg->getKind() < (int)acs.size() && msg == acs[msg->getKind()].arrivalEvent) {
+        // EDCA source: queue the packet, and contend if the host is idle
+        AccessCategory& ac = acs[msg->getKind()];
+        ac.queue.push_back({simTime(), ac.pkLenBits->intValue()});
+        scheduleAt(simTime() + ac.iaTime->doubleValue(), msg);
+        if (state == IDLE && !RTSEvent->isScheduled() && !backoff->isScheduled())
+            startAccess();
     } else {
         if (strcmp(msg->getName(), endListenName) == 0) {
             // EV << "finish receive other host\n";
@@ -167,8 +252,10 @@ void Host::handleMessage(cMessage *msg)
             if (state == FREEZE && channelBusy == 0) {
                 // At begin, this part is schedule a DIFSEvent, then execute below code
                 // Now, this part is executed directly
-                scheduleAt(simTime() + DIFS + backoffTime, RTSEvent);
-                DIFS_FLAG = simTime();
+                // (an EDCA countdown may still run if the frame went unheard)
+                if (edca)
+                    pauseContention();
+                scheduleContention();
             }
         } else if (strcmp(msg->getName(), "CTS_up") == 0) {
             if (state == WAIT_CTS) {
@@ -198,10 +285,7 @@ void Host::handleMessage(cMessage *msg)
                 EV << "host " << getIndex() << " content fail and freeze\n";
                 // while RTS collision, don't receive CTS, then create a new backoffTime below
                 // then next other RTS arrive, backoffTime is not changed
-                if (backoffTime - (simTime() - DIFS_FLAG - DIFS) > 0) {
-                    backoffTime = backoffTime - (simTime() - DIFS_FLAG - DIFS);
-                }
-                cancelEvent(RTSEvent);
+                pauseContention();
                 contentFailFlag = true;
             }
 
@@ -229,6 +313,11 @@ void Host::handleMessage(cMessage *msg)
                 EV << "host " << getIndex() << " backoff while waiting for DIFS\n";
                 scheduleAt(simTime(), backoff);
                 cancelEvent(endTxEvent);
+            } else if (edca && state == FREEZE) {
+                // a frame whose RTS went unheard also stops the EDCA countdown;
+                // its endListen restarts it
+                EV << "host " << getIndex() << " frame heard, freeze\n";
+                pauseContention();
             }
 
             channelBusy++;
@@ -238,28 +327,203 @@ void Host::handleMessage(cMessage *msg)
 
 }
 
-simtime_t Host::generateBackofftime()
+simtime_t Host::generateBackofftime(AccessCategory& ac)
 {
-    int CW = pow(2, 2 + backoffCount) - 1;
+    int CW = contentionWindow(ac.backoffCount, ac.cwMin, ac.cwMax);
     int slots = intrand(CW + 1);
     EV << "slots: " << slots << endl;
     return slots * slotTime;
 };
 
+void Host::increaseBackoff(AccessCategory& ac)
+{
+    // the window stops growing at cwMax
+    if (contentionWindow(ac.backoffCount, ac.cwMin, ac.cwMax) < ac.cwMax) {
+        ac.backoffCount += 1;
+    }
+    ac.backoffTime = generateBackofftime(ac);
+}
+
+void Host::startAccess()
+{
+    // the highest class with a packet; scheduleContention() may pick another
+    int i = acs.size() - 1;
+    while (i >= 0 && acs[i].queue.empty())
+        i--;
+    if (i < 0)
+        return;
+    currentAC = i;
+
+    if (channelBusy == 0) {
+        if (state == IDLE && !edca) {
+            // while channel is free and state is idle, wait for DIFS
+            scheduleAt(simTime() + DIFS, RTSEvent);
+        } else if (state == IDLE || state == FREEZE) {
+            // FREEZE: maybe this part is not needed, its implementation is below
+            // IDLE with EDCA: the AIFS and backoff countdown runs in FREEZE, so
+            // that an RTS or a frame heard meanwhile pauses it
+            state = FREEZE;
+            scheduleContention();
+        }
+    } else {
+        scheduleAt(simTime(), backoff);
+    }
+}
+
+void Host::scheduleContention()
+{
+    // the class whose AIFS and backoff run out first gets the channel, the
+    // higher one on a tie; the losers of a tie back off in resolveInternalCollision()
+    simtime_t earliest = SIMTIME_MAX;
+    for (int i = acs.size() - 1; i >= 0; i--) {
+        AccessCategory& ac = acs[i];
+        if (!ac.queue.empty() && ac.aifs + ac.backoffTime < earliest) {
+            earliest = ac.aifs + ac.backoffTime;
+            currentAC = i;
+        }
+    }
+    if (earliest == SIMTIME_MAX)
+        throw cRuntimeError("Contention without a queued packet");
+
+    scheduleAt(simTime() + earliest, RTSEvent);
+    DIFS_FLAG = simTime();
+}
+
+void Host::resolveInternalCollision()
+{
+    // lower classes whose backoff ran out in the same slot lose to currentAC
+    // and back off as if their frame had collided on the air; the others
+    // keep what is left of their backoff, as after a freeze
+    AccessCategory& winner = acs[currentAC];
+    for (int i = 0; i < (int)acs.size(); i++) {
+        AccessCategory& ac = acs[i];
+        if (i == currentAC || ac.queue.empty())
+            continue;
+        if (ac.aifs + ac.backoffTime == winner.aifs + winner.backoffTime) {
+            EV << "host " << getIndex() << " internal collision, " << ac.name << " yields to " << winner.name << "\n";
+            increaseBackoff(ac);
+        } else {
+            simtime_t elapsed = simTime() - DIFS_FLAG - ac.aifs;
+            if (elapsed > 0)
+                ac.backoffTime = ac.backoffTime - elapsed;
+        }
+    }
+}
+
+void Host::pauseContention()
+{
+    // only a running countdown can be paused; the legacy MAC subtracts from
+    // its backoff in FREEZE in any case, and keeps doing so
+    if (edca && !RTSEvent->isScheduled())
+        return;
+    for (auto& ac : acs) {
+        if (ac.queue.empty())
+            continue;
+        // every class counts down only after its own AIFS; an RTS
+        // within the AIFS leaves an EDCA backoff untouched (the
+        // legacy MAC adds the rest of its DIFS instead)
+        simtime_t elapsed = simTime() - DIFS_FLAG - ac.aifs;
+        if (edca && elapsed < 0)
+            elapsed = 0;
+        if (ac.backoffTime - elapsed > 0) {
+            ac.backoffTime = ac.backoffTime - elapsed;
+        }
+    }
+    cancelEvent(RTSEvent);
+}
+
+bool Host::continueTxop()
+{
+    // the next frame of the class follows after SIFS if it still fits into the TXOP
+    AccessCategory& ac = acs[currentAC];
+    if (ac.txopLimit <= 0 || ac.queue.empty())
+        return false;
+    simtime_t duration = ac.queue.front().bitLength / txRate;
+    return simTime() - txopStart + SIFS + duration <= ac.txopLimit;
+}
+
+simtime_t Host::computeDelay(double px, double py) const
+{
+    return DelayCache::propagationDelay(x - px, y - py);
+}
+
+Host *Host::getOtherHost(int index) const
+{
+    return hostTable->getHost(index < getIndex() ? index : index + 1);
+}
+
+cGate *Host::getOtherHostGate(int index) const
+{
+    return hostTable->getHostGate(index < getIndex() ? index : index + 1);
+}
+
+simtime_t Host::getOtherHostDelay(int index)
+{
+    // recompute only if either end has moved since the entry was cached
+    Host *other = getOtherHost(index);
+    return otherHostDelays.get(index, x, y, other->getX(), other->getY(), other->getPositionVersion());
+}
+
+void Host::move()
+{
+    if (!mobility->move(x, y, mobilityUpdateInterval.dbl()))
+        return;
+
+    // peers notice the new version lazily; only our own row is dropped here
+    positionVersion++;
+    otherHostDelays.invalidate();
+
+    Server *srv = check_and_cast<Server *>(server);
+    radioDelay = computeDelay(srv->getX(), srv->getY());
+
+    getDisplayString().setTagArg("p", 0, x);
+    getDisplayString().setTagArg("p", 1, y);
+}
+
 simtime_t Host::getNextTransmissionTime()
 {
-    simtime_t t = simTime() + iaTime->doubleValue();
+    simtime_t t = simTime() + acs[0].iaTime->doubleValue();
 
     return t;
 }
 
+bool Host::isSensed(cMessage *msg)
+{
+    Host *sender = dynamic_cast<Host *>(msg->getSenderModule());
+    if (sender == nullptr)
+        return true; // CTS frames of the server are always received
+
+    int index = otherHostIndex(sender->getIndex());
+    if (strcmp(msg->getName(), endListenName) == 0) {
+        // only the end of a transmission this host noticed frees the channel;
+        // few peers transmit at once, so the list stays short
+        auto it = std::find(sensedOtherHosts.begin(), sensedOtherHosts.end(), index);
+        if (it == sensedOtherHosts.end())
+            return false;
+        sensedOtherHosts.erase(it);
+        return true;
+    }
+
+    // energy detection: everything on the air at our position, not just this
+    // frame, but without our own transmission
+    bool busy = medium->getTotalPower(x, y, getId()) >= medium->getCarrierSenseThreshold();
+    if (busy && strcmp(msg->getName(), "RTS") != 0 &&
+            std::find(sensedOtherHosts.begin(), sensedOtherHosts.end(), index) == sensedOtherHosts.end())
+        sensedOtherHosts.push_back(index);
+    return busy;
+}
+
 void Host::sendRTS(){
+    txopStart = simTime();
+    if (medium != nullptr)
+        medium->addTransmission(getId(), x, y, txPower, simTime() + RTS_TIME);
+
     cPacket *RTS = new cPacket("RTS");
     sendDirect(RTS, radioDelay, RTS_TIME, server->gate("in"));
 
     for (int i = 0; i < numOtherHosts; i++) {
         RTS = new cPacket("RTS");
-        sendDirect(RTS, otherHostDelay[i], RTS_TIME, otherHostGate[i]);
+        sendDirect(RTS, getOtherHostDelay(i), RTS_TIME, getOtherHostGate(i));
     }
 
     // if don't get CTS, backoff
@@ -273,21 +537,32 @@ void Host::sendPacket(cPacket *pk) {
     emit(stateSignal, state);
     
     simtime_t duration = pk->getBitLength() / txRate;
+    AccessCategory& ac = acs[currentAC];
+    simtime_t delay = simTime() - ac.queue.front().arrival;
+    ac.queue.pop_front();
+    emit(accessDelaySignal, delay);
+    if (edca)
+        emit(ac.delaySignal, delay);
+    if (medium != nullptr)
+        medium->addTransmission(getId(), x, y, txPower, simTime() + duration);
     sendDirect(pk, radioDelay, duration, server->gate("in"));
 
     for (int i = 0; i < numOtherHosts; i++) {
-        snprintf(broadcast, sizeof(broadcast), "from-%d, to-%d", getIndex(), otherHosts[i]->getIndex());
+        snprintf(broadcast, sizeof(broadcast), "from-%d, to-%d", getIndex(), getOtherHost(i)->getIndex());
         // EV << "generating packet " << broadcast << endl;
 
         cMessage *broadcastPacket = new cMessage(broadcast);
 
-        sendDirect(broadcastPacket, otherHostDelay[i], \
-                    0, otherHostGate[i]);
+        sendDirect(broadcastPacket, getOtherHostDelay(i), \
+                    0, getOtherHostGate(i));
     }
 
     scheduleAt(simTime()+duration, endTxEvent);
     
-    backoffTime = 0;
+    ac.backoffTime = 0;
+    // the legacy MAC keeps its window after a success, EDCA restarts from cwMin
+    if (edca)
+        ac.backoffCount = 0;
 
     // let visualization code know about the new packet
     if (transmissionRing != nullptr) {
@@ -304,6 +579,115 @@ void Host::sendPacket(cPacket *pk) {
     }
 }
 
+// queued packets as "arrival/bitLength,...", arrival relative to now; "-" if empty
+static std::string queueToString(const std::deque<AccessCategory::Packet>& queue)
+{
+    if (queue.empty())
+        return "-";
+    std::string str;
+    for (auto& p : queue) {
+        if (!str.empty())
+            str += ",";
+        str += (p.arrival - simTime()).str() + "/" + std::to_string(p.bitLength);
+    }
+    return str;
+}
+
+static void queueFromString(const std::string& str, std::deque<AccessCategory::Packet>& queue)
+{
+    queue.clear();
+    if (str == "-")
+        return;
+    cStringTokenizer tokenizer(str.c_str(), ",");
+    while (tokenizer.hasMoreTokens()) {
+        std::string token = tokenizer.nextToken();
+        size_t slash = token.find('/');
+        if (slash == std::string::npos)
+            throw cRuntimeError("Snapshot: malformed queue entry '%s'", token.c_str());
+        simtime_t arrival = simTime() + SimTime::parse(token.substr(0, slash).c_str());
+        queue.push_back({arrival, std::stoll(token.substr(slash + 1))});
+    }
+}
+
+void Host::saveState(SnapshotSection& s) const
+{
+    s.setLong("state", state);
+    s.setLong("pkCounter", pkCounter);
+    s.setLong("channelBusy", channelBusy);
+    s.setTime("DIFS_FLAG", DIFS_FLAG - simTime());
+    s.setLong("contentFailFlag", contentFailFlag);
+    s.setLong("currentAC", currentAC);
+    s.setTime("txopStart", txopStart - simTime());
+    for (auto& ac : acs) {
+        // the legacy category has no name and keeps the unprefixed keys
+        std::string prefix = ac.name.empty() ? "" : ac.name + ".";
+        s.setLong((prefix + "backoffCount").c_str(), ac.backoffCount);
+        s.setTime((prefix + "backoffTime").c_str(), ac.backoffTime);
+        s.set((prefix + "queue").c_str(), queueToString(ac.queue));
+    }
+    s.setDouble("x", x);
+    s.setDouble("y", y);
+    // informational only: restored runs are re-seeded
+    s.setLong("rngNumbersDrawn", getRNG(0)->getNumbersDrawn());
+
+    std::vector<const cMessage *> timers = { endTxEvent, DIFSEvent, RTSEvent, backoff, cancleChannelBusy, moveEvent };
+    for (auto& ac : acs)
+        timers.push_back(ac.arrivalEvent);
+    for (const cMessage *timer : timers)
+        if (timer != nullptr)
+            s.setTimer(timer->getName(), timer);
+}
+
+void Host::restoreState(const SnapshotSection& s)
+{
+    Enter_Method_Silent();
+
+    state = static_cast<decltype(state)>(s.getLong("state"));
+    pkCounter = s.getLong("pkCounter");
+    channelBusy = s.getLong("channelBusy");
+    DIFS_FLAG = simTime() + s.getTime("DIFS_FLAG");
+    contentFailFlag = s.getLong("contentFailFlag") != 0;
+    currentAC = s.getLong("currentAC");
+    txopStart = simTime() + s.getTime("txopStart");
+    if (currentAC < 0 || currentAC >= (int)acs.size())
+        throw cRuntimeError("Snapshot was taken with a different number of access categories");
+    for (auto& ac : acs) {
+        std::string prefix = ac.name.empty() ? "" : ac.name + ".";
+        ac.backoffCount = s.getLong((prefix + "backoffCount").c_str());
+        ac.backoffTime = s.getTime((prefix + "backoffTime").c_str());
+        queueFromString(s.get((prefix + "queue").c_str()), ac.queue);
+    }
+
+    x = s.getDouble("x");
+    y = s.getDouble("y");
+    positionVersion++;
+    otherHostDelays.invalidate();
+    Server *srv = check_and_cast<Server *>(server);
+    radioDelay = computeDelay(srv->getX(), srv->getY());
+    getDisplayString().setTagArg("p", 0, x);
+    getDisplayString().setTagArg("p", 1, y);
+
+    std::vector<cMessage *> timers = { endTxEvent, DIFSEvent, RTSEvent, backoff, cancleChannelBusy, moveEvent };
+    for (auto& ac : acs)
+        timers.push_back(ac.arrivalEvent);
+    for (cMessage *timer : timers) {
+        if (timer == nullptr)
+            continue;
+        cancelEvent(timer);
+        simtime_t remaining;
+        if (s.getTimer(timer->getName(), remaining))
+            scheduleAt(simTime() + remaining, timer);
+    }
+
+    emit(stateSignal, state);
+}
+
+void Host::restoreFrame(const SnapshotFrame& f, cGate *dest)
+{
+    Enter_Method_Silent();
+    sendDirect(f.create(), f.remaining, f.duration, dest);
+}
+
 void Host::refreshDisplay() const
 {
     cCanvas *canvas = getParentModule()->getCanvas();
@@ -350,8 +734,8 @@ void Host::refreshDisplay() const
         simtime_t backTravelTime = now - (lastPacket->getSendingTime() + lastPacket->getDuration());
 
         // conversion from time to distance in m using speed
-        double frontRadius = std::min(ringMaxRadius, frontTravelTime.dbl() * propagationSpeed);
-        double backRadius = backTravelTime.dbl() * propagationSpeed;
+        double frontRadius = std::min(ringMaxRadius, frontTravelTime.dbl() * DelayCache::propagationSpeed);
+        double backRadius = backTravelTime.dbl() * DelayCache::propagationSpeed;
         double circleRadiusIncrement = circlesMaxRadius / numCircles;
 
         // update transmission ring geometry and visibility/opacity
@@ -377,7 +761,7 @@ void Host::refreshDisplay() const
         transmissionRing->setFillOpacity(opacity/5);
 
         // update transmission circles geometry and visibility/opacity
-        double radius0 = std::fmod(frontTravelTime.dbl() * propagationSpeed, circleRadiusIncrement);
+        double radius0 = std::fmod(frontTravelTime.dbl() * DelayCache::propagationSpeed, circleRadiusIncrement);
         for (int i = 0; i < (int)transmissionCircles.size(); ++i) {
             double circleRadius = std::min(ringMaxRadius, radius0 + i * circleRadiusIncrement);
             if (circleRadius < frontRadius - circleRadiusIncrement/2 && circleRadius > backRadius + circleLineWidth/2) {
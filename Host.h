@@ -10,12 +10,52 @@
 #ifndef __ALOHA_HOST_H_
 #define __ALOHA_HOST_H_
 
+#include <algorithm>
+#include <climits>
+#include <deque>
+#include <string>
+#include <vector>
+
 #include <omnetpp.h>
 
+#include "DelayCache.h"
+#include "Mobility.h"
+#include "RadioMedium.h"
+#include "Snapshot.h"
+
 using namespace omnetpp;
 
 namespace csma {
 
+class Server;
+
+/**
+ * A traffic class with its own queue and contention parameters, i.e. an
+ * EDCA access category. Without EDCA the host has a single one that
+ * stands for the legacy DIFS and backoff rule.
+ */
+struct AccessCategory
+{
+    struct Packet
+    {
+        simtime_t arrival;
+        int64_t bitLength; // -1: drawn when the packet is sent
+    };
+
+    std::string name; // "BK", "BE", "VI" or "VO"; empty without EDCA
+    simtime_t aifs;
+    int cwMin;
+    int cwMax;
+    simtime_t txopLimit; // zero means one frame per channel access
+    cPar *iaTime;
+    cPar *pkLenBits;
+    std::deque<Packet> queue;
+    cMessage *arrivalEvent = nullptr; // EDCA only, the legacy source is DIFSEvent
+    int backoffCount = 0;
+    simtime_t backoffTime;
+    simsignal_t delaySignal = 0; // EDCA only, percentiles in DelayStatistics
+};
+
 /**
  * CSMA host; see NED file for more info.
  */
@@ -25,9 +65,8 @@ class Host : public cSimpleModule, public cListener
     // parameters
     simtime_t radioDelay;
     double txRate;
-    cPar *iaTime;
-    cPar *pkLenBits;
     simtime_t slotTime;
+    bool edca;
 
     // state variables, event pointers etc
     cModule *server;
@@ -35,13 +74,22 @@ class Host : public cSimpleModule, public cListener
     enum { IDLE = 0, WAIT_CTS = 1, BEFORE_SNED = 2, TRANSMIT = 3, FREEZE = 4} state;
     simsignal_t stateSignal;
     simsignal_t channelStateSignal;
+    simsignal_t accessDelaySignal;
     int pkCounter;
 
+    // in increasing priority; the one contending or transmitting is currentAC
+    std::vector<AccessCategory> acs;
+    int currentAC;
+    simtime_t txopStart; // start of the current channel access (the RTS)
+
     // position on the canvas, unit is m
     double x, y;
+    // bumped on every move; peers compare it against their cached delays
+    long positionVersion;
 
-    // speed of light in m/s
-    const double propagationSpeed = 299792458.0;
+    MobilityModel *mobility = nullptr;
+    simtime_t mobilityUpdateInterval;
+    cMessage *moveEvent = nullptr;
 
     // animation parameters
     const double ringMaxRadius = 2000; // in m
@@ -59,9 +107,6 @@ class Host : public cSimpleModule, public cListener
     cMessage *DIFSEvent = nullptr;
 
     int channelBusy;
-    simtime_t backoffTime;
-    int maxBackoffs;
-    int backoffCount;
     cMessage *backoff = nullptr;
 
     // simtime_t SIFS;
@@ -73,10 +118,12 @@ class Host : public cSimpleModule, public cListener
     cPacket *pk;
     char pkname[40];
 
+    // peers are numbered 0..numOtherHosts-1, skipping this host; the host
+    // and gate tables are the server's, so a host stores nothing per peer
+    // apart from otherHostDelays, which stays empty above maxDelayCachePeers
     int numOtherHosts;
-    cModule **otherHosts;
-    cGate **otherHostGate;
-    simtime_t *otherHostDelay;
+    Server *hostTable;
+    DelayCache otherHostDelays;
     char broadcast[40];
     
     cMessage *endListen = nullptr;
@@ -88,17 +135,51 @@ class Host : public cSimpleModule, public cListener
 
     cMessage *cancleChannelBusy = nullptr;
 
+    // physical layer, nullptr unless CSMA.withPhy is set
+    RadioMedium *medium = nullptr;
+    double txPower; // in mW
+    std::vector<int> sensedOtherHosts; // peers whose data frame was sensed, their endListen counts
+
   public:
     virtual ~Host();
 
+    double getX() const { return x; }
+    double getY() const { return y; }
+    long getPositionVersion() const { return positionVersion; }
+    int getState() const { return state; }
+    double getTxPower() const { return txPower; }
+    simtime_t computeDelay(double px, double py) const;
+
+    // shared with benchmarks/mac_bench.cc
+    // doubles from cwMin on every backoff up to cwMax; the defaults are the legacy 2^(2+backoffCount)-1
+    static int contentionWindow(int backoffCount, int cwMin = 3, int cwMax = INT_MAX) { return std::min(((cwMin + 1) << backoffCount) - 1, cwMax); }
+
+    // warm-start support, see SnapshotManager
+    void saveState(SnapshotSection& s) const;
+    void restoreState(const SnapshotSection& s);
+    void restoreFrame(const SnapshotFrame& f, cGate *dest);
+
   protected:
     virtual void initialize() override;
     virtual void handleMessage(cMessage *msg) override;
     virtual void refreshDisplay() const override;
-    simtime_t generateBackofftime();
+    void initAccessCategories();
+    simtime_t generateBackofftime(AccessCategory& ac);
+    void increaseBackoff(AccessCategory& ac);
     simtime_t getNextTransmissionTime();
+    void startAccess();
+    void scheduleContention();
+    void resolveInternalCollision();
+    void pauseContention();
+    bool continueTxop();
     void sendRTS();
     void sendPacket(cPacket *pk);
+    void move();
+    simtime_t getOtherHostDelay(int index);
+    int otherHostIndex(int hostIndex) const { return hostIndex < getIndex() ? hostIndex : hostIndex - 1; }
+    Host *getOtherHost(int index) const;
+    cGate *getOtherHostGate(int index) const;
+    bool isSensed(cMessage *msg);
     virtual void receiveSignal(cComponent *source, simsignal_t signalID, intval_t i, cObject *details) override;
 };
 
@@ -0,0 +1,85 @@
+//
+// This file is part of an OMNeT++/OMNEST simulation example.
+//
+// Copyright (C) 1992-2015 Andras Varga
+//
+// This file is distributed WITHOUT ANY WARRANTY. See the file
+// `license' for details on this and other legal matters.
+//
+
+#ifndef __CSMA_METRICSBLOCK_H_
+#define __CSMA_METRICSBLOCK_H_
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+// Shared by MetricsExporter and tools/csma_metrics; must not depend on OMNeT++.
+
+namespace csma {
+
+const uint32_t METRICS_MAGIC = 0x43534d41; // "CSMA"
+const uint32_t METRICS_VERSION = 1;
+const int METRICS_NUM_HOST_STATES = 5;     // IDLE, WAIT_CTS, BEFORE_SNED, TRANSMIT, FREEZE
+
+/**
+ * Payload of the metrics block, copied as a whole under the seqlock.
+ */
+struct MetricsData
+{
+    double simTime;
+    double wallTime;           // seconds since the exporter started
+    double eventsPerSec;       // over the last publishing interval
+    double channelUtilization; // successful reception time / simTime so far
+    uint64_t eventNumber;
+    uint64_t receivedFrames;
+    uint64_t collisions;
+    uint64_t collidedFrames;
+    uint64_t fesLength;
+    uint32_t running;          // 0 once the simulation has finished
+    uint32_t numHosts;
+    uint32_t hostStates[METRICS_NUM_HOST_STATES]; // number of hosts in each state
+};
+
+/**
+ * Fixed-layout block in the shared memory segment. The single writer
+ * (the simulation) never waits; readers retry while a write is in
+ * progress, which is signalled by an odd sequence number.
+ */
+struct MetricsBlock
+{
+    uint32_t magic;
+    uint32_t version;
+    std::atomic<uint64_t> sequence;
+    MetricsData data;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "seqlock needs a lock-free 64-bit atomic");
+
+inline void writeMetrics(MetricsBlock *block, const MetricsData& data)
+{
+    uint64_t seq = block->sequence.load(std::memory_order_relaxed);
+    block->sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&block->data, &data, sizeof(data));
+    block->sequence.store(seq + 2, std::memory_order_release);
+}
+
+// returns false if the writer was busy on every attempt
+inline bool readMetrics(const MetricsBlock *block, MetricsData& data, int maxAttempts = 1000)
+{
+    for (int i = 0; i < maxAttempts; i++) {
+        uint64_t before = block->sequence.load(std::memory_order_acquire);
+        if (before & 1)
+            continue;
+        memcpy(&data, &block->data, sizeof(data));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (block->sequence.load(std::memory_order_relaxed) == before)
+            return true;
+    }
+    return false;
+}
+
+}; //namespace
+
+#endif
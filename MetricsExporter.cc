@@ -0,0 +1,153 @@
+//
+// This file is part of an OMNeT++/OMNEST simulation example.
+//
+// Copyright (C) 1992-2015 Andras Varga
+//
+// This file is distributed WITHOUT ANY WARRANTY. See the file
+// `license' for details on this and other legal matters.
+//
+
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "MetricsExporter.h"
+#include "Host.h"
+
+namespace csma {
+
+Define_Module(MetricsExporter);
+
+MetricsExporter::~MetricsExporter()
+{
+    delete [] hosts;
+    if (block != nullptr) {
+        munmap(block, sizeof(MetricsBlock));
+        shm_unlink(shmName.c_str());
+    }
+}
+
+void MetricsExporter::initialize()
+{
+    shmName = par("shmName").stdstringValue();
+    interval = par("interval").doubleValue();
+
+    int fd = shm_open(shmName.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0)
+        throw cRuntimeError("Cannot open shared memory segment '%s': %s", shmName.c_str(), strerror(errno));
+    if (ftruncate(fd, sizeof(MetricsBlock)) != 0) {
+        close(fd);
+        throw cRuntimeError("Cannot size shared memory segment '%s': %s", shmName.c_str(), strerror(errno));
+    }
+    void *p = mmap(nullptr, sizeof(MetricsBlock), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+        throw cRuntimeError("Cannot map shared memory segment '%s': %s", shmName.c_str(), strerror(errno));
+    block = static_cast<MetricsBlock *>(p);
+    block->magic = METRICS_MAGIC;
+    block->version = METRICS_VERSION;
+    block->sequence.store(0, std::memory_order_relaxed);
+
+    numHosts = getParentModule()->par("numHosts");
+    hosts = new Host *[numHosts];
+    char hostname[16];
+    for (int i = 0; i < numHosts; i++) {
+        snprintf(hostname, sizeof(hostname), "host[%d]", i);
+        hosts[i] = check_and_cast<Host *>(getModuleByPath(hostname));
+    }
+
+    // no timer of its own: publishing is driven by these signals, so the
+    // exporter adds no events and leaves fingerprints alone; the hosts'
+    // state changes propagate to the network module
+    cModule *server = getModuleByPath("server");
+    receiveSignalId = registerSignal("receive");
+    collisionSignalId = registerSignal("collision");
+    stateSignalId = registerSignal("state");
+    server->subscribe(receiveSignalId, this);
+    server->subscribe(collisionSignalId, this);
+    getParentModule()->subscribe(stateSignalId, this);
+    busyTime = 0;
+    receiveStart = 0;
+    receivedFrames = 0;
+    collisions = 0;
+    collidedFrames = 0;
+
+    startTime = lastPublishTime = Clock::now();
+    lastEventNumber = getSimulation()->getEventNumber();
+    publish(true);
+}
+
+void MetricsExporter::handleMessage(cMessage *msg)
+{
+    throw cRuntimeError("This module does not process messages");
+}
+
+void MetricsExporter::checkPublish()
+{
+    // only reads the clock; the block is rewritten once per interval
+    if (std::chrono::duration<double>(Clock::now() - lastPublishTime).count() >= interval)
+        publish(true);
+}
+
+void MetricsExporter::receiveSignal(cComponent *source, simsignal_t signalID, cObject *obj, cObject *details)
+{
+    cITimestampedValue *value = check_and_cast<cITimestampedValue *>(obj);
+    if (signalID == receiveSignalId) {
+        // 1 at the start, 0 at the end of a reception, both timestamped
+        if (value->intValue(signalID) != 0) {
+            receiveStart = value->getTimestamp(signalID);
+            receivedFrames++;
+        }
+        else
+            busyTime += value->getTimestamp(signalID) - receiveStart;
+    }
+    else if (signalID == collisionSignalId) {
+        collisions++;
+        collidedFrames += value->intValue(signalID);
+    }
+    checkPublish();
+}
+
+void MetricsExporter::receiveSignal(cComponent *source, simsignal_t signalID, intval_t i, cObject *details)
+{
+    // host state changes, and the initial plain 0 of "receive"
+    checkPublish();
+}
+
+void MetricsExporter::publish(bool running)
+{
+    Clock::time_point now = Clock::now();
+    int64_t eventNumber = getSimulation()->getEventNumber();
+    double dt = std::chrono::duration<double>(now - lastPublishTime).count();
+
+    MetricsData data;
+    memset(&data, 0, sizeof(data));
+    data.simTime = simTime().dbl();
+    data.wallTime = std::chrono::duration<double>(now - startTime).count();
+    data.eventsPerSec = dt > 0 ? (eventNumber - lastEventNumber) / dt : 0;
+    data.channelUtilization = simTime() > 0 ? busyTime / simTime() : 0;
+    data.eventNumber = eventNumber;
+    data.receivedFrames = receivedFrames;
+    data.collisions = collisions;
+    data.collidedFrames = collidedFrames;
+    data.fesLength = getSimulation()->getFES()->getLength();
+    data.running = running;
+    data.numHosts = numHosts;
+    for (int i = 0; i < numHosts; i++) {
+        int state = hosts[i]->getState();
+        if (state >= 0 && state < METRICS_NUM_HOST_STATES)
+            data.hostStates[state]++;
+    }
+
+    writeMetrics(block, data);
+    lastPublishTime = now;
+    lastEventNumber = eventNumber;
+}
+
+void MetricsExporter::finish()
+{
+    publish(false);
+}
+
+}; //namespace
@@ -0,0 +1,72 @@
+//
+// This file is part of an OMNeT++/OMNEST simulation example.
+//
+// Copyright (C) 1992-2015 Andras Varga
+//
+// This file is distributed WITHOUT ANY WARRANTY. See the file
+// `license' for details on this and other legal matters.
+//
+
+#ifndef __CSMA_METRICSEXPORTER_H_
+#define __CSMA_METRICSEXPORTER_H_
+
+#include <chrono>
+#include <string>
+
+#include <omnetpp.h>
+
+#include "MetricsBlock.h"
+
+using namespace omnetpp;
+
+namespace csma {
+
+class Host;
+
+/**
+ * Publishes live metrics into shared memory; see NED file for more info.
+ */
+class MetricsExporter : public cSimpleModule, public cListener
+{
+  private:
+    typedef std::chrono::steady_clock Clock;
+
+    // parameters
+    std::string shmName;
+    double interval;
+
+    MetricsBlock *block = nullptr;
+
+    int numHosts;
+    Host **hosts = nullptr;
+
+    simsignal_t receiveSignalId;
+    simsignal_t collisionSignalId;
+    simsignal_t stateSignalId;
+    simtime_t busyTime;
+    simtime_t receiveStart; // of the reception being reported
+    uint64_t receivedFrames;
+    uint64_t collisions;
+    uint64_t collidedFrames;
+
+    Clock::time_point startTime;
+    Clock::time_point lastPublishTime;
+    int64_t lastEventNumber;
+
+  public:
+    virtual ~MetricsExporter();
+
+  protected:
+    virtual void initialize() override;
+    virtual void handleMessage(cMessage *msg) override;
+    virtual void finish() override;
+    virtual void receiveSignal(cComponent *source, simsignal_t signalID, cObject *obj, cObject *details) override;
+    virtual void receiveSignal(cComponent *source, simsignal_t signalID, intval_t i, cObject *details) override;
+
+    void checkPublish();
+    void publish(bool running);
+};
+
+}; //namespace
+
+#endif
@@ -0,0 +1,112 @@
+//
+// This file is part of an OMNeT++/OMNEST simulation example.
+//
+// Copyright (C) 1992-2015 Andras Varga
+//
+// This file is distributed WITHOUT ANY WARRANTY. See the file
+// `license' for details on this and other legal matters.
+//
+
+#include "Mobility.h"
+
+namespace csma {
+
+// mirrors a coordinate back into [lo, hi]; flips the velocity on every bounce
+static void reflect(double& pos, double& v, double lo, double hi)
+{
+    if (lo == hi) {
+        // degenerate axis: nothing to bounce off, the host is pinned to it
+        pos = lo;
+        v = 0;
+        return;
+    }
+    while (pos < lo || pos > hi) {
+        if (pos < lo)
+            pos = 2 * lo - pos;
+        else
+            pos = 2 * hi - pos;
+        v = -v;
+    }
+}
+
+MobilityModel::MobilityModel(cComponent *owner, double minX, double minY, double maxX, double maxY) :
+    owner(owner), minX(minX), minY(minY), maxX(maxX), maxY(maxY)
+{
+    if (minX > maxX || minY > maxY)
+        throw cRuntimeError("Invalid mobility constraint area");
+}
+
+MobilityModel *MobilityModel::create(const char *type, cComponent *owner,
+        double minX, double minY, double maxX, double maxY)
+{
+    if (strcmp(type, "static") == 0)
+        return nullptr;
+    else if (strcmp(type, "linear") == 0)
+        return new LinearMobility(owner, minX, minY, maxX, maxY);
+    else if (strcmp(type, "randomWaypoint") == 0)
+        return new RandomWaypointMobility(owner, minX, minY, maxX, maxY);
+    else
+        throw cRuntimeError("Unknown mobilityType '%s'", type);
+}
+
+LinearMobility::LinearMobility(cComponent *owner, double minX, double minY, double maxX, double maxY) :
+    MobilityModel(owner, minX, minY, maxX, maxY)
+{
+    double speed = owner->par("speed").doubleValue();
+    double heading = owner->par("heading").doubleValue() * M_PI / 180;
+    vx = speed * std::cos(heading);
+    vy = speed * std::sin(heading);
+}
+
+bool LinearMobility::move(double& x, double& y, double dt)
+{
+    if (vx == 0 && vy == 0)
+        return false;
+
+    x += vx * dt;
+    y += vy * dt;
+    reflect(x, vx, minX, maxX);
+    reflect(y, vy, minY, maxY);
+    return true;
+}
+
+bool RandomWaypointMobility::move(double& x, double& y, double dt)
+{
+    bool moved = false;
+    while (dt > 0) {
+        if (pauseLeft > 0) {
+            double t = std::min(pauseLeft, dt);
+            pauseLeft -= t;
+            dt -= t;
+            continue;
+        }
+        if (!hasTarget) {
+            targetX = owner->uniform(minX, maxX);
+            targetY = owner->uniform(minY, maxY);
+            speed = owner->par("speed").doubleValue();
+            hasTarget = true;
+            if (speed <= 0)
+                throw cRuntimeError("randomWaypoint mobility needs a positive speed");
+        }
+
+        double dx = targetX - x, dy = targetY - y;
+        double dist = std::sqrt(dx * dx + dy * dy);
+        double step = speed * dt;
+        moved = true;
+        if (step < dist) {
+            x += dx * step / dist;
+            y += dy * step / dist;
+            break;
+        }
+
+        // waypoint reached: consume the travel time and pause there
+        x = targetX;
+        y = targetY;
+        dt -= dist / speed;
+        hasTarget = false;
+        pauseLeft = owner->par("waitTime").doubleValue();
+    }
+    return moved;
+}
+
+}; //namespace
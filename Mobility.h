@@ -0,0 +1,75 @@
+//
+// This file is part of an OMNeT++/OMNEST simulation example.
+//
+// Copyright (C) 1992-2015 Andras Varga
+//
+// This file is distributed WITHOUT ANY WARRANTY. See the file
+// `license' for details on this and other legal matters.
+//
+
+#ifndef __CSMA_MOBILITY_H_
+#define __CSMA_MOBILITY_H_
+
+#include <omnetpp.h>
+
+using namespace omnetpp;
+
+namespace csma {
+
+/**
+ * Moves a host inside a rectangular constraint area. Positions are in m,
+ * speeds in m/s. The owner module supplies the random numbers and the
+ * volatile "speed", "heading" and "waitTime" parameters.
+ */
+class MobilityModel
+{
+  protected:
+    cComponent *owner;
+    double minX, minY, maxX, maxY;
+
+  public:
+    MobilityModel(cComponent *owner, double minX, double minY, double maxX, double maxY);
+    virtual ~MobilityModel() {}
+
+    // advances (x, y) by dt seconds; returns false if the position did not change
+    virtual bool move(double& x, double& y, double dt) = 0;
+
+    // returns nullptr for "static", throws for unknown types
+    static MobilityModel *create(const char *type, cComponent *owner,
+            double minX, double minY, double maxX, double maxY);
+};
+
+/**
+ * Straight-line movement with constant velocity, reflected at the borders
+ * of the constraint area.
+ */
+class LinearMobility : public MobilityModel
+{
+  private:
+    double vx, vy;
+
+  public:
+    LinearMobility(cComponent *owner, double minX, double minY, double maxX, double maxY);
+    virtual bool move(double& x, double& y, double dt) override;
+};
+
+/**
+ * Random waypoint: pick a uniform destination in the constraint area, travel
+ * there at a random speed, pause for a random time, repeat.
+ */
+class RandomWaypointMobility : public MobilityModel
+{
+  private:
+    bool hasTarget = false;
+    double targetX = 0, targetY = 0;
+    double speed = 0;
+    double pauseLeft = 0;
+
+  public:
+    using MobilityModel::MobilityModel;
+    virtual bool move(double& x, double& y, double dt) override;
+};
+
+}; //namespace
+
+#endif
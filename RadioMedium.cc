@@ -0,0 +1,84 @@
+//
+// This file is part of an OMNeT++/OMNEST simulation example.
+//
+// Copyright (C) 1992-2015 Andras Varga
+//
+// This file is distributed WITHOUT ANY WARRANTY. See the file
+// `license' for details on this and other legal matters.
+//
+
+#include "RadioMedium.h"
+
+namespace csma {
+
+Define_Module(RadioMedium);
+
+void RadioMedium::initialize()
+{
+    pathLossExponent = par("pathLossExponent");
+    referenceDistance = par("referenceDistance");
+    referenceGain = std::pow(10, -par("referenceLoss").doubleValue() / 10);
+    noisePower = dBmToMilliWatt(par("noiseFloor"));
+    carrierSenseThreshold = dBmToMilliWatt(par("carrierSenseThreshold"));
+    sinrThreshold = std::pow(10, par("sinrThreshold").doubleValue() / 10);
+    if (pathLossExponent <= 0 || referenceDistance <= 0)
+        throw cRuntimeError("pathLossExponent and referenceDistance must be positive");
+
+    WATCH_VECTOR(txPower);
+}
+
+void RadioMedium::handleMessage(cMessage *msg)
+{
+    throw cRuntimeError("RadioMedium does not process messages");
+}
+
+double RadioMedium::getReceivedPower(double srcX, double srcY, double x, double y, double power) const
+{
+    double dx = srcX - x, dy = srcY - y;
+    double d = std::max(std::sqrt(dx * dx + dy * dy), referenceDistance);
+    return power * referenceGain * std::pow(d / referenceDistance, -pathLossExponent);
+}
+
+double RadioMedium::getTotalPower(double x, double y, int exceptOwner)
+{
+    purgeEndedTransmissions();
+
+    // (d/d0)^-n computed as (d^2/d0^2)^(-n/2), which saves the square root
+    double sum = sumAttenuatedPower(txX.data(), txY.data(), txPower.data(), txOwner.data(), txX.size(),
+            x, y, referenceDistance * referenceDistance, -pathLossExponent / 2, exceptOwner);
+    return sum * referenceGain;
+}
+
+void RadioMedium::addTransmission(int owner, double x, double y, double power, simtime_t end)
+{
+    purgeEndedTransmissions();
+    txX.push_back(x);
+    txY.push_back(y);
+    txPower.push_back(power);
+    txOwner.push_back(owner);
+    txEnd.push_back(end);
+}
+
+void RadioMedium::purgeEndedTransmissions()
+{
+    // swap-remove keeps the arrays dense; their order does not matter
+    simtime_t now = simTime();
+    for (size_t i = 0; i < txEnd.size(); ) {
+        if (txEnd[i] <= now) {
+            txX[i] = txX.back();
+            txY[i] = txY.back();
+            txPower[i] = txPower.back();
+            txOwner[i] = txOwner.back();
+            txEnd[i] = txEnd.back();
+            txX.pop_back();
+            txY.pop_back();
+            txPower.pop_back();
+            txOwner.pop_back();
+            txEnd.pop_back();
+        }
+        else
+            i++;
+    }
+}
+
+}; //namespace
@@ -0,0 +1,76 @@
+//
+// This file is part of an OMNeT++/OMNEST simulation example.
+//
+// Copyright (C) 1992-2015 Andras Varga
+//
+// This file is distributed WITHOUT ANY WARRANTY. See the file
+// `license' for details on this and other legal matters.
+//
+
+#ifndef __CSMA_RADIOMEDIUM_H_
+#define __CSMA_RADIOMEDIUM_H_
+
+#include <vector>
+
+#include <omnetpp.h>
+
+using namespace omnetpp;
+
+namespace csma {
+
+// sum over n transmitters of power[i] * (max(d2, minD2) / minD2)^exponent,
+// d2 being the squared distance of (x[i], y[i]) from (rx, ry), skipping those
+// whose owner[i] is exceptOwner; the vectorized kernel of
+// RadioMedium::getTotalPower(), see RadioMediumKernel.cc
+double sumAttenuatedPower(const double *x, const double *y, const double *power, const int *owner, int n,
+        double rx, double ry, double minD2, double exponent, int exceptOwner);
+
+/**
+ * Log-distance path loss and the set of ongoing transmissions; see NED
+ * file for more info. Powers are in mW.
+ */
+class RadioMedium : public cSimpleModule
+{
+  private:
+    // parameters, converted to linear units
+    double pathLossExponent;
+    double referenceDistance;
+    double referenceGain; // 1 / path loss at referenceDistance
+    double noisePower;
+    double carrierSenseThreshold;
+    double sinrThreshold;
+
+    // ongoing transmissions as structure of arrays, so that the power sum
+    // over them is a plain loop the compiler can vectorize (sumAttenuatedPower)
+    std::vector<double> txX;
+    std::vector<double> txY;
+    std::vector<double> txPower;
+    std::vector<int> txOwner; // module id of the transmitter
+    std::vector<simtime_t> txEnd;
+
+    void purgeEndedTransmissions();
+
+  public:
+    static double dBmToMilliWatt(double dBm) { return std::pow(10, dBm / 10); }
+
+    double getNoisePower() const { return noisePower; }
+    double getCarrierSenseThreshold() const { return carrierSenseThreshold; }
+    double getSinrThreshold() const { return sinrThreshold; }
+
+    // received power at (x, y) of a transmitter at (srcX, srcY)
+    double getReceivedPower(double srcX, double srcY, double x, double y, double power) const;
+    // sum of the received powers at (x, y) of all ongoing transmissions but
+    // those of exceptOwner (a module id), e.g. of the host sensing the channel
+    double getTotalPower(double x, double y, int exceptOwner = -1);
+
+    void addTransmission(int owner, double x, double y, double power, simtime_t end);
+    int getNumTransmissions() const { return txX.size(); }
+
+  protected:
+    virtual void initialize() override;
+    virtual void handleMessage(cMessage *msg) override;
+};
+
+}; //namespace
+
+#endif
@@ -8,6 +8,8 @@
 //
 
 #include "Server.h"
+#include "Host.h"
+#include "Topology.h"
 
 namespace csma {
 
@@ -39,9 +41,6 @@ void Server::initialize()
     emit(receiveSignal, 0L);
     emit(receiveBeginSignal, 0L);
 
-    getDisplayString().setTagArg("p", 0, par("x").doubleValue());
-    getDisplayString().setTagArg("p", 1, par("y").doubleValue());
-
     SIFS = par("SIFS");
     CTS_TIME = par("CTS");
 
@@ -50,26 +49,38 @@ void Server::initialize()
     
     CTS_flag = false;
     CTS_FREEZE_flag = false;
+    CTS_direction = -1;
 
-    x = par("x").doubleValue();
-    y = par("y").doubleValue();
+    const char *topologyFile = par("topologyFile");
+    if (*topologyFile) {
+        const Topology *topology = Topology::get(topologyFile);
+        x = topology->getServerX();
+        y = topology->getServerY();
+    }
+    else {
+        x = par("x").doubleValue();
+        y = par("y").doubleValue();
+    }
+    getDisplayString().setTagArg("p", 0, x);
+    getDisplayString().setTagArg("p", 1, y);
 
     numHosts = par("numHosts");
-    Hosts = new cModule *[numHosts];
+    Hosts = new Host *[numHosts];
     HostGate = new cGate *[numHosts];
-    HostDelay = new simtime_t[numHosts];
-    char hostname[10] = "host[x]";
+    HostDelays.setSize(numHosts);
+    cModule *network = getParentModule();
     for (int i = 0; i < numHosts; i++) {
-        snprintf(hostname, sizeof(hostname), "host[%d]", i);
-        Hosts[i] = getModuleByPath(hostname);
+        Hosts[i] = check_and_cast<Host *>(network->getSubmodule("host", i));
         HostGate[i] = Hosts[i]->gate("in");
-
-        double dist = std::sqrt((x-Hosts[i]->par("x").doubleValue()) * \
-                    (x-Hosts[i]->par("x").doubleValue()) + \
-                    (y-Hosts[i]->par("y").doubleValue()) * \
-                    (y-Hosts[i]->par("y").doubleValue()));
-        HostDelay[i] = dist / propagationSpeed;
     }
+
+    medium = dynamic_cast<RadioMedium *>(network->getSubmodule("medium"));
+}
+
+simtime_t Server::getHostDelay(int i)
+{
+    // hosts may move; recompute only entries whose host changed position
+    return HostDelays.get(i, x, y, Hosts[i]->getX(), Hosts[i]->getY(), Hosts[i]->getPositionVersion());
 }
 
 void Server::handleMessage(cMessage *msg)
@@ -81,14 +92,16 @@ void Server::handleMessage(cMessage *msg)
 
         // update statistics
         simtime_t dt = simTime() - recvStartTime;
-        if (currentCollisionNumFrames == 0) {
-            // start of reception at recvStartTime
-            cTimestampedValue tmp(recvStartTime, (intval_t)1);
-            emit(receiveSignal, &tmp);
-            // end of reception now
-            emit(receiveSignal, 0);
+        if (medium != nullptr) {
+            // with SINR reception a frame can survive overlapping ones (capture);
+            // only the airtime of the surviving frames counts as received
+            emitSurvivingReceptions();
+            receptions.clear();
         }
-        else {
+        else if (currentCollisionNumFrames == 0) {
+            emitReception(recvStartTime, simTime());
+        }
+        if (currentCollisionNumFrames != 0) {
             // start of collision at recvStartTime
             cTimestampedValue tmp(recvStartTime, currentCollisionNumFrames);
             emit(collisionSignal, &tmp);
@@ -100,6 +113,10 @@ void Server::handleMessage(cMessage *msg)
         receiveCounter = 0;
         emit(receiveBeginSignal, receiveCounter);
     } else if (strcmp(msg->getName(), RTS) == 0){
+        // an RTS adds interference to the data frames being received
+        if (medium != nullptr)
+            checkReceptions();
+
         // TODO: if many hosts send RTS at the same time, how to solve the collision?
         // method1: only send CTS to the last one
         // method2: send CTS to all hosts, but carry the index of the last host, and the host will check if the CTS is for itself
@@ -132,10 +149,10 @@ void Server::handleMessage(cMessage *msg)
         for (int i = 0; i < numHosts; i++) {
             if (i == CTS_direction) {
                 cPacket *CTS_send = new cPacket("CTS_up");
-                sendDirect(CTS_send, HostDelay[i], CTS_TIME, HostGate[i]);
+                sendDirect(CTS_send, getHostDelay(i), CTS_TIME, HostGate[i]);
             } else {
                 cPacket *CTS_send = new cPacket("CTS_down");
-                sendDirect(CTS_send, HostDelay[i], CTS_TIME, HostGate[i]);
+                sendDirect(CTS_send, getHostDelay(i), CTS_TIME, HostGate[i]);
             }
         }
         CTS_flag = false;
@@ -150,7 +167,10 @@ void Server::handleMessage(cMessage *msg)
 
         emit(receiveBeginSignal, ++receiveCounter);
 
-        if (!channelBusy) {
+        if (medium != nullptr) {
+            receiveWithSinr(pkt, endReceptionTime);
+        }
+        else if (!channelBusy) {
             EV << "started receiving\n";
             recvStartTime = simTime();
             channelBusy = true;
@@ -184,6 +204,131 @@ void Server::handleMessage(cMessage *msg)
     }
 }
 
+void Server::receiveWithSinr(cPacket *pkt, simtime_t endReceptionTime)
+{
+    Host *sender = check_and_cast<Host *>(pkt->getSenderModule());
+    Reception reception;
+    reception.signal = medium->getReceivedPower(sender->getX(), sender->getY(), x, y, sender->getTxPower());
+    reception.start = simTime();
+    reception.end = endReceptionTime;
+    reception.ok = true;
+    receptions.push_back(reception);
+
+    if (!channelBusy) {
+        EV << "started receiving\n";
+        recvStartTime = simTime();
+        emit(channelStateSignal, TRANSMISSION);
+        scheduleAt(endReceptionTime, endRxEvent);
+    }
+    else if (endReceptionTime > endRxEvent->getArrivalTime()) {
+        cancelEvent(endRxEvent);
+        scheduleAt(endReceptionTime, endRxEvent);
+    }
+
+    checkReceptions();
+}
+
+void Server::emitReception(simtime_t start, simtime_t end)
+{
+    // 1 at the start of the reception, 0 at its end
+    cTimestampedValue startValue(start, (intval_t)1);
+    emit(receiveSignal, &startValue);
+    cTimestampedValue endValue(end, (intval_t)0);
+    emit(receiveSignal, &endValue);
+}
+
+void Server::emitSurvivingReceptions()
+{
+    // receptions are in order of their start; survivors only overlap if
+    // sinrThreshold is below 0dB, and are then reported as one reception
+    simtime_t start = -1, end;
+    for (auto& r : receptions) {
+        if (!r.ok)
+            continue;
+        if (start >= 0 && r.start <= end) {
+            end = std::max(end, r.end);
+            continue;
+        }
+        if (start >= 0)
+            emitReception(start, end);
+        start = r.start;
+        end = r.end;
+    }
+    if (start >= 0)
+        emitReception(start, end);
+}
+
+void Server::checkReceptions()
+{
+    // interference only grows when a frame starts, so checking then is enough
+    double total = medium->getTotalPower(x, y);
+    for (auto& r : receptions) {
+        if (!r.ok || r.end <= simTime())
+            continue;
+        double interference = medium->getNoisePower() + total - r.signal;
+        if (r.signal < medium->getSinrThreshold() * interference) {
+            EV << "frame lost, SINR " << 10 * std::log10(r.signal / interference) << "dB\n";
+            r.ok = false;
+            currentCollisionNumFrames++;
+            emit(channelStateSignal, COLLISION);
+        }
+    }
+}
+
+void Server::saveState(SnapshotSection& s) const
+{
+    s.setLong("channelBusy", channelBusy);
+    s.setLong("currentCollisionNumFrames", currentCollisionNumFrames);
+    s.setLong("receiveCounter", receiveCounter);
+    s.setTime("recvStartTime", recvStartTime - simTime());
+    s.setLong("CTS_flag", CTS_flag);
+    s.setLong("CTS_FREEZE_flag", CTS_FREEZE_flag);
+    s.setLong("CTS_direction", CTS_direction);
+    s.setDouble("x", x);
+    s.setDouble("y", y);
+
+    const cMessage *timers[] = { endRxEvent, CTS, CTS_UNFREEZE };
+    for (const cMessage *timer : timers)
+        s.setTimer(timer->getName(), timer);
+}
+
+void Server::restoreState(const SnapshotSection& s)
+{
+    Enter_Method_Silent();
+
+    channelBusy = s.getLong("channelBusy") != 0;
+    currentCollisionNumFrames = s.getLong("currentCollisionNumFrames");
+    receiveCounter = s.getLong("receiveCounter");
+    // a reception in progress is accounted from t=0 in the statistics
+    recvStartTime = std::max(simTime() + s.getTime("recvStartTime"), SIMTIME_ZERO);
+    CTS_flag = s.getLong("CTS_flag") != 0;
+    CTS_FREEZE_flag = s.getLong("CTS_FREEZE_flag") != 0;
+    CTS_direction = s.getLong("CTS_direction");
+
+    x = s.getDouble("x");
+    y = s.getDouble("y");
+    HostDelays.invalidate();
+    getDisplayString().setTagArg("p", 0, x);
+    getDisplayString().setTagArg("p", 1, y);
+
+    cMessage *timers[] = { endRxEvent, CTS, CTS_UNFREEZE };
+    for (cMessage *timer : timers) {
+        cancelEvent(timer);
+        simtime_t remaining;
+        if (s.getTimer(timer->getName(), remaining))
+            scheduleAt(simTime() + remaining, timer);
+    }
+
+    emit(channelStateSignal, !channelBusy ? IDLE : currentCollisionNumFrames == 0 ? TRANSMISSION : COLLISION);
+    emit(receiveBeginSignal, receiveCounter);
+}
+
+void Server::restoreFrame(const SnapshotFrame& f, cGate *dest)
+{
+    Enter_Method_Silent();
+    sendDirect(f.create(), f.remaining, f.duration, dest);
+}
+
 void Server::refreshDisplay() const
 {
     if (!channelBusy) {
@@ -10,12 +10,21 @@
 #ifndef __ALOHA_SERVER_H_
 #define __ALOHA_SERVER_H_
 
+#include <vector>
+
 #include <omnetpp.h>
 
+#include "DelayCache.h"
+#include "RadioMedium.h"
+
+#include "Snapshot.h"
+
 using namespace omnetpp;
 
 namespace csma {
 
+class Host;
+
 /**
  * CSMA server; see NED file for more info.
  */
@@ -43,13 +52,12 @@ class Server : public cSimpleModule
 
     char RTS[4] = "RTS";
 
-    const double propagationSpeed = 299792458.0;
     double x, y;
 
     int numHosts;
-    cModule **Hosts;
+    Host **Hosts;
     cGate **HostGate;
-    simtime_t *HostDelay;
+    DelayCache HostDelays;
 
     cMessage *CTS;
     bool CTS_flag;
@@ -57,14 +65,41 @@ class Server : public cSimpleModule
     cMessage *CTS_UNFREEZE;
     bool CTS_FREEZE_flag;
 
+    // physical layer, nullptr unless CSMA.withPhy is set
+    RadioMedium *medium = nullptr;
+    struct Reception {
+        double signal; // received power in mW
+        simtime_t start;
+        simtime_t end;
+        bool ok;       // SINR stayed above the threshold so far
+    };
+    std::vector<Reception> receptions; // data frames of the current busy period
+
   public:
     virtual ~Server();
 
+    double getX() const { return x; }
+    double getY() const { return y; }
+
+    // every host and its input gate, shared with the hosts' fan-out loops
+    Host *getHost(int i) const { return Hosts[i]; }
+    cGate *getHostGate(int i) const { return HostGate[i]; }
+
+    // warm-start support, see SnapshotManager
+    void saveState(SnapshotSection& s) const;
+    void restoreState(const SnapshotSection& s);
+    void restoreFrame(const SnapshotFrame& f, cGate *dest);
+
   protected:
     virtual void initialize() override;
     virtual void handleMessage(cMessage *msg) override;
     virtual void finish() override;
     virtual void refreshDisplay() const override;
+    simtime_t getHostDelay(int i);
+    void receiveWithSinr(cPacket *pkt, simtime_t endReceptionTime);
+    void checkReceptions();
+    void emitReception(simtime_t start, simtime_t end);
+    void emitSurvivingReceptions();
 };
 
 }; //namespace
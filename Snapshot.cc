@@ -0,0 +1,166 @@
+//
+// This file is part of an OMNeT++/OMNEST simulation example.
+//
+// Copyright (C) 1992-2015 Andras Varga
+//
+// This file is distributed WITHOUT ANY WARRANTY. See the file
+// `license' for details on this and other legal matters.
+//
+
+#include <fstream>
+#include <sstream>
+
+#include "Snapshot.h"
+
+namespace csma {
+
+static const char *MAGIC = "csma-snapshot";
+static const int VERSION = 2;
+
+void SnapshotSection::setLong(const char *key, long value)
+{
+    values[key] = std::to_string(value);
+}
+
+void SnapshotSection::setDouble(const char *key, double value)
+{
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.17g", value);
+    values[key] = buf;
+}
+
+void SnapshotSection::setTime(const char *key, simtime_t value)
+{
+    values[key] = value.str();
+}
+
+void SnapshotSection::setTimer(const char *key, const cMessage *msg)
+{
+    if (msg != nullptr && msg->isScheduled())
+        setTime(key, msg->getArrivalTime() - simTime());
+}
+
+const std::string& SnapshotSection::get(const char *key) const
+{
+    auto it = values.find(key);
+    if (it == values.end())
+        throw cRuntimeError("Snapshot: missing key '%s'", key);
+    return it->second;
+}
+
+long SnapshotSection::getLong(const char *key) const
+{
+    return std::stol(get(key));
+}
+
+double SnapshotSection::getDouble(const char *key) const
+{
+    return std::stod(get(key));
+}
+
+simtime_t SnapshotSection::getTime(const char *key) const
+{
+    return SimTime::parse(get(key).c_str());
+}
+
+bool SnapshotSection::getTimer(const char *key, simtime_t& remaining) const
+{
+    if (!has(key))
+        return false;
+    remaining = getTime(key);
+    return true;
+}
+
+cMessage *SnapshotFrame::create() const
+{
+    if (!isPacket)
+        return new cMessage(name.c_str());
+    cPacket *pkt = new cPacket(name.c_str());
+    pkt->setBitLength(bitLength);
+    return pkt;
+}
+
+void Snapshot::write(const char *fileName) const
+{
+    std::ofstream out(fileName);
+    if (!out)
+        throw cRuntimeError("Cannot open snapshot file '%s' for writing", fileName);
+
+    out << MAGIC << " " << VERSION << "\n";
+    out << "time " << time.str() << "\n";
+    for (auto& section : sections) {
+        out << "[" << section.first << "]\n";
+        for (auto& kv : section.second.getValues())
+            out << kv.first << " " << kv.second << "\n";
+    }
+    out << "[frames]\n";
+    for (auto& f : frames)
+        out << f.sender << " " << f.dest << " " << f.isPacket << " " << f.bitLength << " "
+            << f.duration.str() << " " << f.remaining.str() << " " << f.name << "\n";
+
+    if (!out)
+        throw cRuntimeError("Error writing snapshot file '%s'", fileName);
+}
+
+void Snapshot::read(const char *fileName)
+{
+    std::ifstream in(fileName);
+    if (!in)
+        throw cRuntimeError("Cannot open snapshot file '%s'", fileName);
+
+    std::string line, magic;
+    int version = 0;
+    if (!std::getline(in, line) || !(std::istringstream(line) >> magic >> version) || magic != MAGIC || version != VERSION)
+        throw cRuntimeError("'%s' is not a version %d snapshot file", fileName, VERSION);
+
+    sections.clear();
+    frames.clear();
+    SnapshotSection *section = nullptr;
+    bool inFrames = false;
+    int lineNo = 1;
+    while (std::getline(in, line)) {
+        lineNo++;
+        if (line.empty())
+            continue;
+        if (line[0] == '[') {
+            std::string name = line.substr(1, line.size() - 2);
+            inFrames = name == "frames";
+            section = inFrames ? nullptr : &sections[name];
+            continue;
+        }
+
+        std::istringstream is(line);
+        if (inFrames) {
+            SnapshotFrame f;
+            std::string duration, remaining;
+            if (!(is >> f.sender >> f.dest >> f.isPacket >> f.bitLength >> duration >> remaining))
+                throw cRuntimeError("%s:%d: malformed frame line", fileName, lineNo);
+            is >> std::ws;
+            std::getline(is, f.name);
+            f.duration = SimTime::parse(duration.c_str());
+            f.remaining = SimTime::parse(remaining.c_str());
+            frames.push_back(f);
+        }
+        else {
+            std::string key, value;
+            if (!(is >> key >> value))
+                throw cRuntimeError("%s:%d: malformed line", fileName, lineNo);
+            if (key == "time" && section == nullptr)
+                time = SimTime::parse(value.c_str());
+            else if (section != nullptr)
+                section->set(key.c_str(), value);
+            else
+                throw cRuntimeError("%s:%d: value outside of a section", fileName, lineNo);
+        }
+    }
+}
+
+const SnapshotSection& Snapshot::getSection(const char *name) const
+{
+    auto it = sections.find(name);
+    if (it == sections.end())
+        throw cRuntimeError("Snapshot has no state for module '%s'", name);
+    return it->second;
+}
+
+}; //namespace
@@ -0,0 +1,85 @@
+//
+// This file is part of an OMNeT++/OMNEST simulation example.
+//
+// Copyright (C) 1992-2015 Andras Varga
+//
+// This file is distributed WITHOUT ANY WARRANTY. See the file
+// `license' for details on this and other legal matters.
+//
+
+#ifndef __CSMA_SNAPSHOT_H_
+#define __CSMA_SNAPSHOT_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <omnetpp.h>
+
+using namespace omnetpp;
+
+namespace csma {
+
+/**
+ * Key/value state of one module in a snapshot. Times are stored relative
+ * to the snapshot time, so they can be replayed from t=0.
+ */
+class SnapshotSection
+{
+  private:
+    std::map<std::string, std::string> values;
+
+  public:
+    void set(const char *key, const std::string& value) { values[key] = value; }
+    void setLong(const char *key, long value);
+    void setDouble(const char *key, double value);
+    void setTime(const char *key, simtime_t value);
+    // stores the time left until msg fires; nothing if it is not scheduled
+    void setTimer(const char *key, const cMessage *msg);
+
+    bool has(const char *key) const { return values.find(key) != values.end(); }
+    const std::string& get(const char *key) const;
+    long getLong(const char *key) const;
+    double getDouble(const char *key) const;
+    simtime_t getTime(const char *key) const;
+    // returns false if the timer was not scheduled at snapshot time
+    bool getTimer(const char *key, simtime_t& remaining) const;
+
+    const std::map<std::string, std::string>& getValues() const { return values; }
+};
+
+/**
+ * A frame that was in flight between two modules at snapshot time.
+ */
+struct SnapshotFrame
+{
+    std::string sender;
+    std::string dest;
+    std::string name;
+    bool isPacket = false;
+    int64_t bitLength = 0;
+    simtime_t duration;
+    simtime_t remaining;
+
+    // creates the message in the current context (the sender's, after Enter_Method)
+    cMessage *create() const;
+};
+
+/**
+ * Full MAC state of the network at one point in simulation time.
+ */
+class Snapshot
+{
+  public:
+    simtime_t time;
+    std::map<std::string, SnapshotSection> sections;
+    std::vector<SnapshotFrame> frames;
+
+    void write(const char *fileName) const;
+    void read(const char *fileName);
+    const SnapshotSection& getSection(const char *name) const;
+};
+
+}; //namespace
+
+#endif
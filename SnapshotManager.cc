@@ -0,0 +1,126 @@
+//
+// This file is part of an OMNeT++/OMNEST simulation example.
+//
+// Copyright (C) 1992-2015 Andras Varga
+//
+// This file is distributed WITHOUT ANY WARRANTY. See the file
+// `license' for details on this and other legal matters.
+//
+
+#include "SnapshotManager.h"
+#include "Host.h"
+#include "Server.h"
+
+namespace csma {
+
+Define_Module(SnapshotManager);
+
+SnapshotManager::~SnapshotManager()
+{
+    cancelAndDelete(saveEvent);
+}
+
+void SnapshotManager::initialize(int stage)
+{
+    // hosts and server set up their own state in stage 0; overwrite it in stage 1
+    if (stage != 1)
+        return;
+
+    if (getParentModule()->getSubmodule("medium") != nullptr && (*par("loadFile").stringValue() || *par("saveFile").stringValue()))
+        throw cRuntimeError("Snapshots do not cover the physical layer state, disable CSMA.withPhy");
+
+    const char *loadFile = par("loadFile");
+    if (*loadFile)
+        loadSnapshot(loadFile);
+
+    if (*par("saveFile").stringValue()) {
+        saveEvent = new cMessage("saveSnapshot");
+        scheduleAt(par("saveTime"), saveEvent);
+    }
+}
+
+void SnapshotManager::handleMessage(cMessage *msg)
+{
+    ASSERT(msg == saveEvent);
+    saveSnapshot(par("saveFile"));
+    if (par("endAfterSave").boolValue())
+        endSimulation();
+}
+
+void SnapshotManager::saveSnapshot(const char *fileName)
+{
+    Snapshot snapshot;
+    snapshot.time = simTime();
+
+    Server *server = check_and_cast<Server *>(getModuleByPath("server"));
+    server->saveState(snapshot.sections[server->getFullName()]);
+
+    int numHosts = getParentModule()->par("numHosts");
+    char hostname[16];
+    for (int i = 0; i < numHosts; i++) {
+        snprintf(hostname, sizeof(hostname), "host[%d]", i);
+        Host *host = check_and_cast<Host *>(getModuleByPath(hostname));
+        host->saveState(snapshot.sections[host->getFullName()]);
+    }
+
+    // timers are saved by their owners; here only frames between modules
+    cFutureEventSet *fes = getSimulation()->getFES();
+    for (int i = 0; i < fes->getLength(); i++) {
+        cMessage *msg = dynamic_cast<cMessage *>(fes->get(i));
+        if (msg == nullptr || msg->isSelfMessage() || msg->getSenderModule() == nullptr)
+            continue;
+        SnapshotFrame f;
+        f.sender = msg->getSenderModule()->getFullName();
+        f.dest = msg->getArrivalModule()->getFullName();
+        f.name = msg->getName();
+        if (cPacket *pkt = dynamic_cast<cPacket *>(msg)) {
+            f.isPacket = true;
+            f.bitLength = pkt->getBitLength();
+            f.duration = pkt->getDuration();
+        }
+        f.remaining = msg->getArrivalTime() - simTime();
+        snapshot.frames.push_back(f);
+    }
+
+    snapshot.write(fileName);
+    EV << "snapshot of " << numHosts << " hosts and " << snapshot.frames.size()
+       << " frames in flight written to " << fileName << endl;
+    recordScalar("snapshotSaveTime", simTime());
+}
+
+void SnapshotManager::loadSnapshot(const char *fileName)
+{
+    Snapshot snapshot;
+    snapshot.read(fileName);
+
+    int numHosts = getParentModule()->par("numHosts");
+    int numSaved = snapshot.sections.size() - 1;
+    if (numSaved != numHosts)
+        throw cRuntimeError("Snapshot '%s' has %d hosts, network has %d", fileName, numSaved, numHosts);
+
+    Server *server = check_and_cast<Server *>(getModuleByPath("server"));
+    server->restoreState(snapshot.getSection(server->getFullName()));
+
+    char hostname[16];
+    for (int i = 0; i < numHosts; i++) {
+        snprintf(hostname, sizeof(hostname), "host[%d]", i);
+        Host *host = check_and_cast<Host *>(getModuleByPath(hostname));
+        host->restoreState(snapshot.getSection(hostname));
+    }
+
+    for (auto& f : snapshot.frames) {
+        cModule *dest = getModuleByPath(f.dest.c_str());
+        cModule *sender = getModuleByPath(f.sender.c_str());
+        if (dest == nullptr || sender == nullptr)
+            throw cRuntimeError("Snapshot frame '%s' refers to an unknown module", f.name.c_str());
+        if (Host *host = dynamic_cast<Host *>(sender))
+            host->restoreFrame(f, dest->gate("in"));
+        else
+            check_and_cast<Server *>(sender)->restoreFrame(f, dest->gate("in"));
+    }
+
+    EV << "restored snapshot taken at t=" << snapshot.time << " from " << fileName << endl;
+    recordScalar("snapshotTime", snapshot.time);
+}
+
+}; //namespace
@@ -0,0 +1,42 @@
+//
+// This file is part of an OMNeT++/OMNEST simulation example.
+//
+// Copyright (C) 1992-2015 Andras Varga
+//
+// This file is distributed WITHOUT ANY WARRANTY. See the file
+// `license' for details on this and other legal matters.
+//
+
+#ifndef __CSMA_SNAPSHOTMANAGER_H_
+#define __CSMA_SNAPSHOTMANAGER_H_
+
+#include <omnetpp.h>
+
+#include "Snapshot.h"
+
+using namespace omnetpp;
+
+namespace csma {
+
+/**
+ * Saves and restores warm-start snapshots; see NED file for more info.
+ */
+class SnapshotManager : public cSimpleModule
+{
+  private:
+    cMessage *saveEvent = nullptr;
+
+  public:
+    virtual ~SnapshotManager();
+
+  protected:
+    virtual int numInitStages() const override { return 2; }
+    virtual void initialize(int stage) override;
+    virtual void handleMessage(cMessage *msg) override;
+    void saveSnapshot(const char *fileName);
+    void loadSnapshot(const char *fileName);
+};
+
+}; //namespace
+
+#endif
@@ -0,0 +1,172 @@
+//
+// This file is part of an OMNeT++/OMNEST simulation example.
+//
+// Copyright (C) 1992-2015 Andras Varga
+//
+// This file is distributed WITHOUT ANY WARRANTY. See the file
+// `license' for details on this and other legal matters.
+//
+
+#include <cerrno>
+#include <charconv>
+#include <map>
+#include <memory>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Topology.h"
+
+namespace csma {
+
+/**
+ * The topologies of the current run by file name; emptied when the network
+ * is deleted.
+ */
+class TopologyCache : public cISimulationLifecycleListener
+{
+  public:
+    std::map<std::string, std::unique_ptr<Topology>> topologies;
+    bool registered = false;
+
+    virtual void lifecycleEvent(SimulationLifecycleEventType eventType, cObject *details) override {
+        if (eventType == LF_POST_NETWORK_DELETE)
+            topologies.clear();
+    }
+    virtual void listenerRemoved() override { registered = false; }
+};
+
+static TopologyCache cache;
+
+Topology::Topology(const char *fileName) :
+    fileName(fileName)
+{
+}
+
+const Topology *Topology::get(const char *fileName)
+{
+    if (!cache.registered) {
+        getEnvir()->addLifecycleListener(&cache);
+        cache.registered = true;
+    }
+
+    std::unique_ptr<Topology>& topology = cache.topologies[fileName];
+    if (!topology) {
+        std::unique_ptr<Topology> loaded(new Topology(fileName));
+        loaded->load();
+        topology = std::move(loaded);
+    }
+    return topology.get();
+}
+
+void Topology::load()
+{
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw cRuntimeError("Cannot open topology file '%s': %s", fileName.c_str(), strerror(errno));
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        throw cRuntimeError("Cannot stat topology file '%s': %s", fileName.c_str(), strerror(errno));
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        throw cRuntimeError("Topology file '%s' is empty", fileName.c_str());
+    }
+
+    void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+        throw cRuntimeError("Cannot map topology file '%s': %s", fileName.c_str(), strerror(errno));
+
+    const char *begin = static_cast<const char *>(p);
+    const char *end = begin + st.st_size;
+    hostX.clear();
+    hostY.clear();
+    try {
+        if (st.st_size >= (off_t)sizeof(TOPOLOGY_MAGIC) && memcmp(begin, TOPOLOGY_MAGIC, sizeof(TOPOLOGY_MAGIC)) == 0)
+            parseBinary(begin, end);
+        else
+            parseCsv(begin, end);
+    }
+    catch (...) {
+        munmap(p, st.st_size);
+        throw;
+    }
+    munmap(p, st.st_size);
+}
+
+void Topology::parseCsv(const char *p, const char *end)
+{
+    bool haveServer = false;
+    int lineNo = 0;
+    while (p < end) {
+        const char *eol = static_cast<const char *>(memchr(p, '\n', end - p));
+        if (eol == nullptr)
+            eol = end;
+        lineNo++;
+
+        while (p < eol && (*p == ' ' || *p == '\t'))
+            p++;
+        if (p < eol && *p != '#' && *p != '\r') {
+            double x, y;
+            auto rx = std::from_chars(p, eol, x);
+            const char *q = rx.ptr;
+            while (q < eol && (*q == ' ' || *q == '\t'))
+                q++;
+            if (rx.ec != std::errc() || q == eol || *q != ',')
+                throw cRuntimeError("%s:%d: expected \"x,y\"", fileName.c_str(), lineNo);
+            q++;
+            while (q < eol && (*q == ' ' || *q == '\t'))
+                q++;
+            auto ry = std::from_chars(q, eol, y);
+            if (ry.ec != std::errc())
+                throw cRuntimeError("%s:%d: expected \"x,y\"", fileName.c_str(), lineNo);
+
+            if (!haveServer) {
+                serverX = x;
+                serverY = y;
+                haveServer = true;
+            }
+            else {
+                hostX.push_back(x);
+                hostY.push_back(y);
+            }
+        }
+        p = eol + 1;
+    }
+
+    if (!haveServer)
+        throw cRuntimeError("Topology file '%s' contains no coordinates", fileName.c_str());
+}
+
+void Topology::parseBinary(const char *p, const char *end)
+{
+    const size_t headerSize = sizeof(TOPOLOGY_MAGIC) + 2 * sizeof(uint32_t);
+    if ((size_t)(end - p) < headerSize)
+        throw cRuntimeError("Topology file '%s' is truncated", fileName.c_str());
+
+    uint32_t version, numHosts;
+    memcpy(&version, p + sizeof(TOPOLOGY_MAGIC), sizeof(version));
+    memcpy(&numHosts, p + sizeof(TOPOLOGY_MAGIC) + sizeof(version), sizeof(numHosts));
+    if (version != TOPOLOGY_VERSION)
+        throw cRuntimeError("Topology file '%s' has unsupported version %u", fileName.c_str(), version);
+    // in size_t: numHosts + 1 wraps to 0 in uint32_t for a count of 0xFFFFFFFF
+    if ((size_t)(end - p) != headerSize + ((size_t)numHosts + 1) * 2 * sizeof(double))
+        throw cRuntimeError("Topology file '%s' does not match its host count %u", fileName.c_str(), numHosts);
+
+    const char *coords = p + headerSize;
+    memcpy(&serverX, coords, sizeof(double));
+    memcpy(&serverY, coords + sizeof(double), sizeof(double));
+    hostX.resize(numHosts);
+    hostY.resize(numHosts);
+    for (uint32_t i = 0; i < numHosts; i++) {
+        const char *pair = coords + ((size_t)i + 1) * 2 * sizeof(double);
+        memcpy(&hostX[i], pair, sizeof(double));
+        memcpy(&hostY[i], pair + sizeof(double), sizeof(double));
+    }
+}
+
+}; //namespace
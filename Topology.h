@@ -0,0 +1,62 @@
+//
+// This file is part of an OMNeT++/OMNEST simulation example.
+//
+// Copyright (C) 1992-2015 Andras Varga
+//
+// This file is distributed WITHOUT ANY WARRANTY. See the file
+// `license' for details on this and other legal matters.
+//
+
+#ifndef __CSMA_TOPOLOGY_H_
+#define __CSMA_TOPOLOGY_H_
+
+#include <string>
+#include <vector>
+
+#include <omnetpp.h>
+
+using namespace omnetpp;
+
+namespace csma {
+
+const char TOPOLOGY_MAGIC[8] = { 'C', 'S', 'M', 'A', 'T', 'O', 'P', 'O' };
+const uint32_t TOPOLOGY_VERSION = 1;
+
+/**
+ * Server and host coordinates (in m) read from a placement file, shared by
+ * all modules of a run. Two formats are accepted:
+ *
+ *  - CSV: one "x,y" pair per line, the server first, then the hosts in
+ *    index order; empty lines and lines starting with '#' are skipped.
+ *  - binary: TOPOLOGY_MAGIC, uint32 version, uint32 number of hosts, then
+ *    (1 + number of hosts) pairs of native double x, y in the same order.
+ *
+ * The file is memory-mapped and parsed once per run, by the first module
+ * that asks for it; the others get the cached copy. The cache is dropped
+ * when the network is deleted, so the next run reads the file again.
+ */
+class Topology
+{
+  private:
+    std::string fileName;
+    double serverX = 0, serverY = 0;
+    std::vector<double> hostX, hostY;
+
+    explicit Topology(const char *fileName);
+    void load();
+    void parseCsv(const char *p, const char *end);
+    void parseBinary(const char *p, const char *end);
+
+  public:
+    static const Topology *get(const char *fileName);
+
+    int getNumHosts() const { return hostX.size(); }
+    double getServerX() const { return serverX; }
+    double getServerY() const { return serverY; }
+    double getHostX(int i) const { return hostX[i]; }
+    double getHostY(int i) const { return hostY[i]; }
+};
+
+}; //namespace
+
+#endif
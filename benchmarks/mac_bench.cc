@@ -0,0 +1,216 @@
+//
+// This file is part of an OMNeT++/OMNEST simulation example.
+//
+// Copyright (C) 1992-2015 Andras Varga
+//
+// This file is distributed WITHOUT ANY WARRANTY. See the file
+// `license' for details on this and other legal matters.
+//
+
+// Microbenchmarks of MAC building blocks (Google Benchmark), run with
+// "make bench". They call the model's own code: the contention window rule
+// of Host, the DelayCache behind Host::getOtherHostDelay() and
+// Server::getHostDelay(), and, in BM_FrameFanOut, the whole frame cycle of
+// an embedded CSMA network (sendRTS(), sendPacket() and the endListen
+// fan-out to every peer, with message creation and sendDirect()).
+
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <omnetpp.h>
+#include <omnetpp/cnullenvir.h>
+
+#include "DelayCache.h"
+#include "Host.h"
+
+using namespace omnetpp;
+using namespace csma;
+
+static std::vector<double> randomCoordinates(int n)
+{
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> u(0, 1000);
+    std::vector<double> v(n);
+    for (auto& c : v)
+        c = u(rng);
+    return v;
+}
+
+// Host::generateBackofftime(): contention window and slot draw
+static void BM_Backoff(benchmark::State& state)
+{
+    cMersenneTwister rng;
+    simtime_t slotTime = SimTime(20, SIMTIME_US);
+    const int maxBackoffs = 6;
+    int backoffCount = 0;
+    for (auto _ : state) {
+        int slots = rng.intRand(Host::contentionWindow(backoffCount) + 1);
+        simtime_t backoffTime = slots * slotTime;
+        benchmark::DoNotOptimize(backoffTime);
+        backoffCount = backoffCount < maxBackoffs ? backoffCount + 1 : 0;
+    }
+}
+BENCHMARK(BM_Backoff);
+
+// delay lookups of one frame fan-out (sendRTS, sendPacket, endListen) to
+// n peers that have not moved: all cache hits
+static void BM_DelayFanOut(benchmark::State& state)
+{
+    const int n = state.range(0);
+    std::vector<double> x = randomCoordinates(n), y = randomCoordinates(n);
+    DelayCache cache;
+    cache.setSize(n);
+    for (int i = 0; i < n; i++)
+        cache.get(i, x[0], y[0], x[i], y[i], 0);
+    for (auto _ : state) {
+        for (int i = 0; i < n; i++)
+            benchmark::DoNotOptimize(cache.get(i, x[0], y[0], x[i], y[i], 0));
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_DelayFanOut)->Arg(20)->Arg(200)->Arg(2000);
+
+// the first fan-out after the sender moved (Host::move() invalidates its row)
+static void BM_DelayFanOutAfterMove(benchmark::State& state)
+{
+    const int n = state.range(0);
+    std::vector<double> x = randomCoordinates(n), y = randomCoordinates(n);
+    DelayCache cache;
+    cache.setSize(n);
+    for (auto _ : state) {
+        cache.invalidate();
+        for (int i = 0; i < n; i++)
+            benchmark::DoNotOptimize(cache.get(i, x[0], y[0], x[i], y[i], 0));
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_DelayFanOutAfterMove)->Arg(20)->Arg(200)->Arg(2000);
+
+// every host and the server fanning out once after all hosts moved: the
+// N x N delays the network computes at most once per mobility update
+static void BM_DelayAllAfterMove(benchmark::State& state)
+{
+    const int n = state.range(0);
+    std::vector<double> x = randomCoordinates(n), y = randomCoordinates(n);
+    std::vector<DelayCache> caches(n);
+    for (auto& cache : caches)
+        cache.setSize(n);
+    long version = 0;
+    for (auto _ : state) {
+        version++;
+        for (int j = 0; j < n; j++)
+            for (int i = 0; i < n; i++)
+                benchmark::DoNotOptimize(caches[j].get(i, x[j], y[j], x[i], y[i], version));
+    }
+    state.SetItemsProcessed(state.iterations() * n * n);
+}
+BENCHMARK(BM_DelayAllAfterMove)->Arg(20)->Arg(200)->Arg(2000);
+
+// numHosts of the network BM_FrameFanOut sets up
+static int benchNumHosts;
+
+// no ini file: every setting takes its default
+class BenchConfig : public cConfiguration
+{
+  protected:
+    class NullKeyValue : public KeyValue {
+      public:
+        virtual const char *getKey() const override {return nullptr;}
+        virtual const char *getValue() const override {return nullptr;}
+        virtual const char *getBaseDirectory() const override {return nullptr;}
+    };
+    NullKeyValue nullKeyValue;
+
+    virtual const char *substituteVariables(const char *value) const override {return value;}
+
+  public:
+    virtual const char *getConfigValue(const char *key) const override {return nullptr;}
+    virtual const KeyValue& getConfigEntry(const char *key) const override {return nullKeyValue;}
+    virtual std::vector<const char *> getMatchingConfigKeys(const char *pattern) const override {return std::vector<const char *>();}
+    virtual const char *getParameterValue(const char *moduleFullPath, const char *paramName, bool hasDefaultValue) const override {return nullptr;}
+    virtual const KeyValue& getParameterEntry(const char *moduleFullPath, const char *paramName, bool hasDefaultValue) const override {return nullKeyValue;}
+    virtual std::vector<const char *> getParameterKeyValuePairs() const override {return std::vector<const char *>();}
+    virtual const char *getPerObjectConfigValue(const char *objectFullPath, const char *keySuffix) const override {return nullptr;}
+    virtual const KeyValue& getPerObjectConfigEntry(const char *objectFullPath, const char *keySuffix) const override {return nullKeyValue;}
+    virtual std::vector<const char *> getMatchingPerObjectConfigKeys(const char *objectFullPathPattern) const override {return std::vector<const char *>();}
+    virtual std::vector<const char *> getMatchingPerObjectConfigKeySuffixes(const char *objectFullPath, const char *keySuffixPattern) const override {return std::vector<const char *>();}
+};
+
+// parameters without a NED default get the CSMA1 values of omnetpp.ini
+class BenchEnvir : public cNullEnvir
+{
+  public:
+    BenchEnvir(int argc, char **argv, cConfiguration *cfg) : cNullEnvir(argc, argv, cfg) {}
+
+    virtual void readParameter(cPar *par) override {
+        static const std::map<std::string, std::string> values = {
+            { "txRate", "9.6kbps" }, { "slotTime", "20us" }, { "DIFS", "100us" },
+            { "SIFS", "20us" }, { "RTS", "100us" }, { "CTS", "100us" }, { "maxBackoffs", "6" },
+            { "pkLenBits", "952b" }, { "iaTime", "exponential(2s)" },
+            { "idleAnimationSpeed", "1" }, { "transmissionEdgeAnimationSpeed", "1e-6" },
+            { "midTransmissionAnimationSpeed", "1e-1" },
+        };
+        auto it = values.find(par->getName());
+        if (strcmp(par->getName(), "numHosts") == 0)
+            par->setIntValue(benchNumHosts);
+        else if (it != values.end())
+            par->parse(it->second.c_str());
+        else if (par->containsValue())
+            par->acceptDefault();
+        else
+            throw cRuntimeError("No value for parameter %s", par->getFullPath().c_str());
+    }
+};
+
+// the real MAC of n hosts under CSMA1 load: every RTS, data frame and end of
+// transmission fans out to the n-1 peers, one message and event each
+static void BM_FrameFanOut(benchmark::State& state)
+{
+    const int eventsPerIteration = 10000;
+    benchNumHosts = state.range(0);
+    cSimulation *sim = new cSimulation("bench", new BenchEnvir(0, nullptr, new BenchConfig()));
+    cSimulation::setActiveSimulation(sim);
+    sim->setupNetwork(cModuleType::find("CSMA"));
+    sim->callInitialize();
+
+    for (auto _ : state) {
+        for (int i = 0; i < eventsPerIteration; i++) {
+            cEvent *event = sim->takeNextEvent();
+            if (event == nullptr) {
+                state.SkipWithError("no more events");
+                break;
+            }
+            sim->executeEvent(event);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * eventsPerIteration);
+    state.counters["simsec"] = sim->getSimTime().dbl();
+
+    sim->callFinish();
+    sim->deleteNetwork();
+    cSimulation::setActiveSimulation(nullptr);
+    delete sim;
+}
+BENCHMARK(BM_FrameFanOut)->Arg(20)->Arg(200)->Arg(2000)->Unit(benchmark::kMillisecond);
+
+int main(int argc, char **argv)
+{
+    // simtime_t needs its scale; BM_FrameFanOut sets up its own simulations
+    cStaticFlag dummy;
+    CodeFragments::executeAll(CodeFragments::STARTUP);
+    SimTime::setScaleExp(-12);
+    cSimulation::loadNedSourceFolder("..");
+    cSimulation::doneLoadingNedFiles();
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    CodeFragments::executeAll(CodeFragments::SHUTDOWN);
+    return 0;
+}
@@ -0,0 +1,79 @@
+//
+// This file is part of an OMNeT++/OMNEST simulation example.
+//
+// Copyright (C) 1992-2015 Andras Varga
+//
+// This file is distributed WITHOUT ANY WARRANTY. See the file
+// `license' for details on this and other legal matters.
+//
+
+// Prints the live metrics a running csma simulation publishes through
+// MetricsExporter. Usage: csma_metrics [-n shmName] [-i seconds] [-1]
+
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "MetricsBlock.h"
+
+using namespace csma;
+
+static const char *stateNames[METRICS_NUM_HOST_STATES] = { "idle", "waitCts", "beforeSend", "transmit", "freeze" };
+
+int main(int argc, char **argv)
+{
+    const char *shmName = "/csma-metrics";
+    double interval = 1;
+    bool once = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:i:1h")) != -1) {
+        switch (opt) {
+            case 'n': shmName = optarg; break;
+            case 'i': interval = atof(optarg); break;
+            case '1': once = true; break;
+            default:
+                fprintf(stderr, "usage: %s [-n shmName] [-i seconds] [-1]\n", argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    int fd = shm_open(shmName, O_RDONLY, 0);
+    if (fd < 0) {
+        perror(shmName);
+        return 1;
+    }
+    void *p = mmap(nullptr, sizeof(MetricsBlock), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    const MetricsBlock *block = static_cast<const MetricsBlock *>(p);
+    if (block->magic != METRICS_MAGIC || block->version != METRICS_VERSION) {
+        fprintf(stderr, "%s: not a version %u csma metrics block\n", shmName, METRICS_VERSION);
+        return 1;
+    }
+
+    for (;;) {
+        MetricsData d;
+        if (readMetrics(block, d)) {
+            printf("t=%.6fs wall=%.1fs events=%llu (%.0f/s) fes=%llu util=%.4f rx=%llu coll=%llu (%llu frames)",
+                    d.simTime, d.wallTime, (unsigned long long)d.eventNumber, d.eventsPerSec,
+                    (unsigned long long)d.fesLength, d.channelUtilization, (unsigned long long)d.receivedFrames,
+                    (unsigned long long)d.collisions, (unsigned long long)d.collidedFrames);
+            for (int i = 0; i < METRICS_NUM_HOST_STATES; i++)
+                printf(" %s=%u", stateNames[i], d.hostStates[i]);
+            printf("%s\n", d.running ? "" : " [finished]");
+            fflush(stdout);
+            if (once || !d.running)
+                break;
+        }
+        usleep((useconds_t)(interval * 1e6));
+    }
+
+    munmap(p, sizeof(MetricsBlock));
+    return 0;
+}
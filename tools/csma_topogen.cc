@@ -0,0 +1,133 @@
+//
+// This file is part of an OMNeT++/OMNEST simulation example.
+//
+// Copyright (C) 1992-2015 Andras Varga
+//
+// This file is distributed WITHOUT ANY WARRANTY. See the file
+// `license' for details on this and other legal matters.
+//
+
+// Writes a synthetic placement file for the topologyFile parameter, in the
+// CSV or binary format described in Topology.h. The server is placed in
+// the middle of the area.
+//
+// Usage: csma_topogen -n numHosts [-l uniform|grid|clusters] [-w width]
+//                     [-h height] [-c clusters] [-s seed] [-b] [-o file]
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// keep in sync with TOPOLOGY_MAGIC/TOPOLOGY_VERSION in Topology.h
+static const char MAGIC[8] = { 'C', 'S', 'M', 'A', 'T', 'O', 'P', 'O' };
+static const uint32_t VERSION = 1;
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s -n numHosts [-l uniform|grid|clusters] [-w width] [-h height]\n"
+                    "       [-c clusters] [-s seed] [-b] [-o file]\n", prog);
+    exit(1);
+}
+
+int main(int argc, char **argv)
+{
+    long numHosts = -1;
+    std::string layout = "uniform";
+    double width = 1000, height = 1000;
+    int numClusters = 10;
+    unsigned long seed = 1;
+    bool binary = false;
+    const char *outFile = nullptr;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:l:w:h:c:s:bo:")) != -1) {
+        switch (opt) {
+            case 'n': numHosts = atol(optarg); break;
+            case 'l': layout = optarg; break;
+            case 'w': width = atof(optarg); break;
+            case 'h': height = atof(optarg); break;
+            case 'c': numClusters = atoi(optarg); break;
+            case 's': seed = strtoul(optarg, nullptr, 10); break;
+            case 'b': binary = true; break;
+            case 'o': outFile = optarg; break;
+            default: usage(argv[0]);
+        }
+    }
+    if (numHosts < 0 || width <= 0 || height <= 0 || numClusters < 1)
+        usage(argv[0]);
+
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> ux(0, width), uy(0, height);
+
+    // index 0 is the server, then the hosts
+    std::vector<double> xy;
+    xy.reserve(2 * (numHosts + 1));
+    xy.push_back(width / 2);
+    xy.push_back(height / 2);
+
+    if (layout == "uniform") {
+        for (long i = 0; i < numHosts; i++) {
+            xy.push_back(ux(rng));
+            xy.push_back(uy(rng));
+        }
+    }
+    else if (layout == "grid") {
+        long cols = std::max(1L, (long)std::ceil(std::sqrt((double)numHosts * width / height)));
+        long rows = std::max(1L, (numHosts + cols - 1) / cols);
+        for (long i = 0; i < numHosts; i++) {
+            xy.push_back((i % cols + 0.5) * width / cols);
+            xy.push_back((i / cols + 0.5) * height / rows);
+        }
+    }
+    else if (layout == "clusters") {
+        // hosts gathered around random centres, e.g. rooms of a floor plan
+        std::vector<double> cx(numClusters), cy(numClusters);
+        for (int k = 0; k < numClusters; k++) {
+            cx[k] = ux(rng);
+            cy[k] = uy(rng);
+        }
+        std::uniform_int_distribution<int> pick(0, numClusters - 1);
+        std::normal_distribution<double> spread(0, std::min(width, height) / (4 * std::sqrt((double)numClusters)));
+        for (long i = 0; i < numHosts; i++) {
+            int k = pick(rng);
+            xy.push_back(std::min(width, std::max(0.0, cx[k] + spread(rng))));
+            xy.push_back(std::min(height, std::max(0.0, cy[k] + spread(rng))));
+        }
+    }
+    else {
+        fprintf(stderr, "unknown layout '%s'\n", layout.c_str());
+        return 1;
+    }
+
+    FILE *f = outFile ? fopen(outFile, binary ? "wb" : "w") : stdout;
+    if (f == nullptr) {
+        perror(outFile);
+        return 1;
+    }
+
+    if (binary) {
+        uint32_t n = numHosts;
+        fwrite(MAGIC, sizeof(MAGIC), 1, f);
+        fwrite(&VERSION, sizeof(VERSION), 1, f);
+        fwrite(&n, sizeof(n), 1, f);
+        fwrite(xy.data(), sizeof(double), xy.size(), f);
+    }
+    else {
+        fprintf(f, "# csma topology: server, then %ld hosts (%s layout, %gm x %gm, seed %lu)\n",
+                numHosts, layout.c_str(), width, height, seed);
+        for (size_t i = 0; i < xy.size(); i += 2)
+            fprintf(f, "%.3f,%.3f\n", xy[i], xy[i + 1]);
+    }
+
+    if (ferror(f) || (f != stdout && fclose(f) != 0)) {
+        perror(outFile ? outFile : "stdout");
+        return 1;
+    }
+    return 0;
+}